@@ -66,7 +66,7 @@ const char* getModuleDescription()
 
 const char* getModuleComponentList()
 {
-    return "";
+    return "PulsePatient";
 }
 
 } // namespace pulsephysiology
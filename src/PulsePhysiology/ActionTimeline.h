@@ -0,0 +1,57 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+class SEAction;
+
+/// Actions scheduled on exact time steps, run by HowToTracker::Run in a single step loop
+/// Times are rounded to the nearest time step once, when the timeline is built, so a repeated pattern
+/// such as CPR compressions does not drift. The timeline only refers to the actions, it does not copy them:
+/// an action must outlive the run, and an action whose parameters change over time needs one object per value,
+/// i.e. one compression and one release. Actions scheduled at or after the end are processed after the last step.
+class ActionTimeline
+{
+public:
+  struct Entry
+  {
+    size_t step;            // Processed before computing this time step, counted from the start of the run
+    const SEAction* action;
+  };
+
+  ActionTimeline(double dT_s) : m_dT_s(dT_s), m_NumSteps(0) { }
+
+  /// The time step a time from the start of the run falls on
+  size_t GetStep(double time_s) const
+  {
+    long step = std::lround(time_s / m_dT_s);
+    return step < 0 ? 0 : static_cast<size_t>(step);
+  }
+
+  /// Schedules an action at the given time from the start of the run,
+  /// actions scheduled on the same step are processed in the order they were added
+  void Add(double time_s, const SEAction& action) { AddAtStep(GetStep(time_s), action); }
+  void AddAtStep(size_t step, const SEAction& action)
+  {
+    Entry entry = { step, &action };
+    m_Entries.insert(std::upper_bound(m_Entries.begin(), m_Entries.end(), entry,
+      [](const Entry& a, const Entry& b) { return a.step < b.step; }), entry);
+  }
+
+  /// Length of the run
+  void SetDuration(double time_s) { m_NumSteps = GetStep(time_s); }
+  void SetNumSteps(size_t steps) { m_NumSteps = steps; }
+  size_t GetNumSteps() const { return m_NumSteps; }
+  double GetTimeStep_s() const { return m_dT_s; }
+
+  /// The scheduled actions, ordered by step
+  const std::vector<Entry>& GetEntries() const { return m_Entries; }
+
+private:
+  double m_dT_s;
+  size_t m_NumSteps;
+  std::vector<Entry> m_Entries;
+};
@@ -32,10 +32,10 @@ void HowToAirwayObstruction()
 {
   std::stringstream ss;
   // Create a Pulse Engine and load the standard patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("AirwayObstruction.log");
+  PooledEngine pe = CreateScenarioEngine("AirwayObstruction.log");
   
-  pe->GetLogger()->Info("HowToAirwayObstruction");
-  if (!pe->LoadStateFile("./states/StandardMale@0s.pba"))
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToAirwayObstruction");
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
   {
     pe->GetLogger()->Error("Could not load state, check the error");
     return;
@@ -56,13 +56,13 @@ void HowToAirwayObstruction()
 
   pe->GetEngineTracker()->GetDataRequestManager().SetResultsFilename("AirwayObstruction.csv");
 
-  pe->GetLogger()->Info("The patient is nice and healthy");
-  pe->GetLogger()->Info(std::stringstream() << "Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() << "Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is nice and healthy");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
 
   tracker.AdvanceModelTime(50);
   
@@ -70,35 +70,37 @@ void HowToAirwayObstruction()
   // Set the obstruction severity (a fraction between 0 and 1. For a complete obstruction use 1.)  
   SEAirwayObstruction obstruction;
   obstruction.GetSeverity().SetValue(0.6);
-  pe->ProcessAction(obstruction);
-  pe->GetLogger()->Info("Giving the patient an airway obstruction.");
+  tracker.ProcessAction(obstruction);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Giving the patient an airway obstruction.");
 
   // Advance time to see how the obstruction affects the patient
   tracker.AdvanceModelTime(90);
 
-  pe->GetLogger()->Info(std::stringstream() << "The patient has had an airway obstrcution for 90s, not doing well...");
-  pe->GetLogger()->Info(std::stringstream() << "Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() << "Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient has had an airway obstrcution for 90s, not doing well...");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
 
   // Patient is suffering due to airway blockage
   // You can remove an obstruction by setting the severity to 0, this will remove the blockage to open the airway and the patient will recover.
   obstruction.GetSeverity().SetValue(0.0);
-  pe->ProcessAction(obstruction);
+  tracker.ProcessAction(obstruction);
+  tracker.SetPhase(ScenarioPhase::AfterIntervention);
 
-  pe->GetLogger()->Info("Removing the airway obstruction.");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Removing the airway obstruction.");
 
   tracker.AdvanceModelTime(300);
 
-  pe->GetLogger()->Info(std::stringstream() << "The patient has had the airway obstruction removed for 300s, Patient is much better");
-  pe->GetLogger()->Info(std::stringstream() << "Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() << "Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient has had the airway obstruction removed for 300s, Patient is much better");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
\ No newline at end of file
@@ -39,9 +39,9 @@
 void HowToAnesthesiaMachine()
 {
   // Create the engine and load the patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("AnesthesiaMachine.log");
-  pe->GetLogger()->Info("HowToAnesthesiaMachine");
-  if (!pe->LoadStateFile("./states/StandardMale@0s.pba"))
+  PooledEngine pe = CreateScenarioEngine("AnesthesiaMachine.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToAnesthesiaMachine");
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
   {
     pe->GetLogger()->Error("Could not load state, check the error");
     return;
@@ -65,13 +65,13 @@ void HowToAnesthesiaMachine()
 
   pe->GetEngineTracker()->GetDataRequestManager().SetResultsFilename("AnesthesiaMachine.csv");
 
-  pe->GetLogger()->Info("The patient is nice and healthy");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is nice and healthy");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
 
   tracker.AdvanceModelTime(50);
 
@@ -98,18 +98,18 @@ void HowToAnesthesiaMachine()
   config.GetOxygenBottleTwo().GetVolume().SetValue(660.0, VolumeUnit::L);
 
   // Process the action to propagate state into the engine
-  pe->ProcessAction(AMConfig);
-  pe->GetLogger()->Info(std::stringstream() <<"Turning on the Anesthesia Machine and placing mask on patient for spontaneous breathing with machine connection.");;
+  tracker.ProcessAction(AMConfig);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Turning on the Anesthesia Machine and placing mask on patient for spontaneous breathing with machine connection.");;
 
   tracker.AdvanceModelTime(60);
 
-  pe->GetLogger()->Info("The patient is attempting to breath normally with Anesthesia Machine connected");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is attempting to breath normally with Anesthesia Machine connected");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
 
     // Get the Succinylcholine substance from the substance manager
   const SESubstance* succs = pe->GetSubstanceManager().GetSubstance("Succinylcholine");
@@ -119,101 +119,107 @@ void HowToAnesthesiaMachine()
   bolus.GetConcentration().SetValue(4820, MassPerVolumeUnit::ug_Per_mL);
   bolus.GetDose().SetValue(20, VolumeUnit::mL);
   bolus.SetAdminRoute(cdm::eSubstanceAdministration_Route_Intravenous);
-  pe->ProcessAction(bolus);
+  tracker.ProcessAction(bolus);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
   
-  pe->GetLogger()->Info("Giving the patient Succinylcholine to test machine-driven ventilation.");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Giving the patient Succinylcholine to test machine-driven ventilation.");
 
   tracker.AdvanceModelTime(60);
 
-  pe->GetLogger()->Info("It has been 60s since the Succinylcholine administration.");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "It has been 60s since the Succinylcholine administration.");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
 
   config.GetInletFlow().SetValue(5.0, VolumePerTimeUnit::L_Per_min);
   config.GetPositiveEndExpiredPressure().SetValue(3.0, PressureUnit::cmH2O);
   config.GetVentilatorPressure().SetValue(22.0, PressureUnit::cmH2O);
-  pe->ProcessAction(AMConfig);
-  pe->GetLogger()->Info("Setting the ventilator pressure to drive the machine. Also increasing the inlet flow and positive end expired pressure to test machine controls.");
+  tracker.ProcessAction(AMConfig);
+  tracker.SetPhase(ScenarioPhase::AfterIntervention);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Setting the ventilator pressure to drive the machine. Also increasing the inlet flow and positive end expired pressure to test machine controls.");
 
   tracker.AdvanceModelTime(60);
    
-  pe->GetLogger()->Info("Patient breathing is being controlled by the machine.");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Patient breathing is being controlled by the machine.");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
 
   config.GetInspiratoryExpiratoryRatio().SetValue(1.0);
   config.GetPositiveEndExpiredPressure().SetValue(1.0, PressureUnit::cmH2O);
   config.GetRespiratoryRate().SetValue(18.0, FrequencyUnit::Per_min);
   config.GetVentilatorPressure().SetValue(10.0, PressureUnit::cmH2O);
-  pe->ProcessAction(AMConfig);
-  pe->GetLogger()->Info("More Anesthesia Machine control manipulation. Increasing respiratory rate, reducing driving pressure and increasing the inspiratory-expiratory ratio.");
+  tracker.ProcessAction(AMConfig);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "More Anesthesia Machine control manipulation. Increasing respiratory rate, reducing driving pressure and increasing the inspiratory-expiratory ratio.");
 
   tracker.AdvanceModelTime(60);
 
-  pe->GetLogger()->Info("Patient breathing is being controlled by the machine.");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Patient breathing is being controlled by the machine.");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
 
   SEMaskLeak AMleak;
   AMleak.GetSeverity().SetValue(0.5);
-  pe->ProcessAction(AMleak);
-  pe->GetLogger()->Info("Testing an anesthesia machine failure mode. The mask is leaking with a severity of 0.5.");
+  tracker.ProcessAction(AMleak);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Testing an anesthesia machine failure mode. The mask is leaking with a severity of 0.5.");
 
   tracker.AdvanceModelTime(60);
 
-  pe->GetLogger()->Info("Patient breathing is being controlled by the machine. The mask has been leaking for 60 seconds.");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Patient breathing is being controlled by the machine. The mask has been leaking for 60 seconds.");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
 
   AMleak.GetSeverity().SetValue(0.0);
-  pe->ProcessAction(AMleak);
-  pe->GetLogger()->Info("Removing the mask leak.");
+  tracker.ProcessAction(AMleak);
+  tracker.SetPhase(ScenarioPhase::AfterIntervention);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Removing the mask leak.");
 
   tracker.AdvanceModelTime(60);
 
   SEOxygenWallPortPressureLoss AMpressureloss;
   AMpressureloss.SetActive(true);
-  pe->ProcessAction(AMpressureloss);
-  pe->GetLogger()->Info("Testing the oxygen pressure loss failure mode. The oxygen pressure from the wall source is dropping.");
+  tracker.ProcessAction(AMpressureloss);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Testing the oxygen pressure loss failure mode. The oxygen pressure from the wall source is dropping.");
 
   tracker.AdvanceModelTime(60);
 
-  pe->GetLogger()->Info("Patient breathing is being controlled by the machine. The wall oxygen pressure loss occurred 60 seconds ago.");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Patient breathing is being controlled by the machine. The wall oxygen pressure loss occurred 60 seconds ago.");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
 
   AMpressureloss.SetActive(false);
-  pe->ProcessAction(AMpressureloss);
-  pe->GetLogger()->Info("Removing the wall oxygen pressure loss action.");
+  tracker.ProcessAction(AMpressureloss);
+  tracker.SetPhase(ScenarioPhase::AfterIntervention);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Removing the wall oxygen pressure loss action.");
 
   tracker.AdvanceModelTime(60);
 
-  pe->GetLogger()->Info("The anesthesia machine is operating normally");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The anesthesia machine is operating normally");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
\ No newline at end of file
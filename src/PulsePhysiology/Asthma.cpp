@@ -33,9 +33,9 @@
 void HowToAsthmaAttack() 
 {
   // Create the engine and load the patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("Asthma.log");
-  pe->GetLogger()->Info("HowToAsthmaAttack");
-  if (!pe->LoadStateFile("./states/StandardMale@0s.pba"))
+  PooledEngine pe = CreateScenarioEngine("Asthma.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToAsthmaAttack");
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
   {
     pe->GetLogger()->Error("Could not load state, check the error");
     return;
@@ -63,15 +63,15 @@ void HowToAsthmaAttack()
   // Cache off compartments of interest!
   const SEGasCompartment* carina = pe->GetCompartments().GetGasCompartment(pulse::PulmonaryCompartment::Carina);
   
-  pe->GetLogger()->Info("The patient is nice and healthy");
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() <<"Hemoglobin Content : " << pe->GetBloodChemistrySystem()->GetHemoglobinContent(MassUnit::g) << MassUnit::g);
-  pe->GetLogger()->Info(std::stringstream() <<"Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"InspiratoryExpiratoryRatio : " << pe->GetRespiratorySystem()->GetInspiratoryExpiratoryRatio());
-  pe->GetLogger()->Info(std::stringstream() <<"Carina InFlow : " << carina->GetInFlow(VolumePerTimeUnit::L_Per_s) << VolumePerTimeUnit::L_Per_s);;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is nice and healthy");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cardiac Output : {}{}", pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Hemoglobin Content : {}{}", pe->GetBloodChemistrySystem()->GetHemoglobinContent(MassUnit::g), MassUnit::g);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "InspiratoryExpiratoryRatio : {}", pe->GetRespiratorySystem()->GetInspiratoryExpiratoryRatio());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carina InFlow : {}{}", carina->GetInFlow(VolumePerTimeUnit::L_Per_s), VolumePerTimeUnit::L_Per_s);;
 
   // Asthma Attack Starts - instantiate an asthma attack action and have the engine process it
   // Asthma is a common inflammatory disease of the airways where air flow into the lungs is partially obstructed. 
@@ -80,35 +80,37 @@ void HowToAsthmaAttack()
   // The higher the severity, the more severe the asthma attack.
   SEAsthmaAttack asthmaAttack;
   asthmaAttack.GetSeverity().SetValue(0.3);
-  pe->ProcessAction(asthmaAttack);
+  tracker.ProcessAction(asthmaAttack);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
 
   tracker.AdvanceModelTime(550);
 
-  pe->GetLogger()->Info("The patient has been having an asthma attack for 550s");
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() <<"Hemoglobin Content : " << pe->GetBloodChemistrySystem()->GetHemoglobinContent(MassUnit::g) << MassUnit::g);
-  pe->GetLogger()->Info(std::stringstream() <<"Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"InspiratoryExpiratoryRatio : " << pe->GetRespiratorySystem()->GetInspiratoryExpiratoryRatio());
-  pe->GetLogger()->Info(std::stringstream() <<"Carina InFlow : " << carina->GetInFlow(VolumePerTimeUnit::L_Per_s) << VolumePerTimeUnit::L_Per_s);;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient has been having an asthma attack for 550s");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cardiac Output : {}{}", pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Hemoglobin Content : {}{}", pe->GetBloodChemistrySystem()->GetHemoglobinContent(MassUnit::g), MassUnit::g);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "InspiratoryExpiratoryRatio : {}", pe->GetRespiratorySystem()->GetInspiratoryExpiratoryRatio());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carina InFlow : {}{}", carina->GetInFlow(VolumePerTimeUnit::L_Per_s), VolumePerTimeUnit::L_Per_s);;
 
   // Asthma Attack Stops
   asthmaAttack.GetSeverity().SetValue(0.0);
-  pe->ProcessAction(asthmaAttack);
+  tracker.ProcessAction(asthmaAttack);
+  tracker.SetPhase(ScenarioPhase::AfterIntervention);
   
   // Advance some time while the patient catches their breath
   tracker.AdvanceModelTime(200);
 
-  pe->GetLogger()->Info("The patient has NOT had an asthma attack for 200s");
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() <<"Hemoglobin Content : " << pe->GetBloodChemistrySystem()->GetHemoglobinContent(MassUnit::g) << MassUnit::g);
-  pe->GetLogger()->Info(std::stringstream() <<"Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"InspiratoryExpiratoryRatio : " << pe->GetRespiratorySystem()->GetInspiratoryExpiratoryRatio());
-  pe->GetLogger()->Info(std::stringstream() <<"Carina InFlow : " << carina->GetInFlow(VolumePerTimeUnit::L_Per_s) << VolumePerTimeUnit::L_Per_s);;
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient has NOT had an asthma attack for 200s");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cardiac Output : {}{}", pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Hemoglobin Content : {}{}", pe->GetBloodChemistrySystem()->GetHemoglobinContent(MassUnit::g), MassUnit::g);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "InspiratoryExpiratoryRatio : {}", pe->GetRespiratorySystem()->GetInspiratoryExpiratoryRatio());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carina InFlow : {}{}", carina->GetInFlow(VolumePerTimeUnit::L_Per_s), VolumePerTimeUnit::L_Per_s);;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
@@ -0,0 +1,219 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "ColumnarResults.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Formats blocks of result rows into a results file
+/// Rows are arrays of doubles, the first value is the time, channels that were not sampled are NaN
+class ResultsFormat
+{
+public:
+  virtual ~ResultsFormat() { }
+  virtual bool Open(const std::string& filename, const std::vector<std::string>& channelNames) = 0;
+  virtual void WriteBlock(const double* rows, size_t numRows) = 0;
+  virtual void Close() = 0;
+};
+
+/// Comma separated values, one row per line, the first column is the time
+class CsvResultsFormat : public ResultsFormat
+{
+public:
+  bool Open(const std::string& filename, const std::vector<std::string>& channelNames) override
+  {
+    m_RowSize = channelNames.size() + 1;
+    m_File.open(filename);
+    if (!m_File)
+      return false;
+    m_File.precision(std::numeric_limits<double>::digits10);
+    m_File << "Time(s)";
+    for (const std::string& name : channelNames)
+      m_File << ',' << name;
+    m_File << '\n';
+    return true;
+  }
+  void WriteBlock(const double* rows, size_t numRows) override
+  {
+    for (size_t r = 0; r < numRows; r++, rows += m_RowSize)
+    {
+      m_File << rows[0];
+      for (size_t c = 1; c < m_RowSize; c++)
+      {
+        m_File << ',';
+        if (!std::isnan(rows[c]))
+          m_File << rows[c];
+      }
+      m_File << '\n';
+    }
+  }
+  void Close() override { m_File.close(); }
+
+protected:
+  size_t m_RowSize;
+  std::ofstream m_File;
+};
+
+/// Binary columnar file, see ColumnarResults.h, read back with ColumnarResults::Reader
+class BinaryResultsFormat : public ResultsFormat
+{
+public:
+  bool Open(const std::string& filename, const std::vector<std::string>& channelNames) override
+  {
+    m_RowSize = channelNames.size() + 1;
+    m_File.open(filename, std::ios::binary);
+    if (!m_File)
+      return false;
+    std::vector<std::string> columnNames;
+    columnNames.push_back("Time(s)");
+    columnNames.insert(columnNames.end(), channelNames.begin(), channelNames.end());
+    ColumnarResults::WriteHeader(m_File, columnNames);
+    return true;
+  }
+  void WriteBlock(const double* rows, size_t numRows) override
+  {
+    ColumnarResults::WriteBlock(m_File, rows, numRows, m_RowSize);
+  }
+  void Close() override { m_File.close(); }
+
+protected:
+  size_t m_RowSize;
+  std::ofstream m_File;
+};
+
+/// Writes result rows to a file from a background thread
+/// Rows are copied into preallocated blocks, when a block is full it is handed to the writer thread,
+/// which formats it and writes it to disk while the simulation thread fills the next block.
+/// The simulation thread only waits if every block is waiting to be written, which is counted as a stall.
+class AsyncResultsWriter
+{
+public:
+  AsyncResultsWriter(std::unique_ptr<ResultsFormat> format, size_t rowsPerBlock = 4096, size_t numBlocks = 2)
+    : m_Format(std::move(format)), m_RowsPerBlock(std::max<size_t>(rowsPerBlock, 1)), m_RowSize(0),
+      m_NumBlocks(std::max<size_t>(numBlocks, 2)), m_Current(nullptr), m_CurrentRows(0), m_Stalls(0), m_Stop(false) { }
+  ~AsyncResultsWriter() { Close(); }
+
+  /// Opens the file and starts the writer thread
+  bool Open(const std::string& filename, const std::vector<std::string>& channelNames)
+  {
+    m_RowSize = channelNames.size() + 1;
+    if (!m_Format->Open(filename, channelNames))
+      return false;
+    m_Blocks.resize(m_NumBlocks);
+    for (Block& b : m_Blocks)
+    {
+      b.rows.resize(m_RowsPerBlock * m_RowSize);
+      b.numRows = 0;
+      m_Free.push_back(&b);
+    }
+    m_Current = m_Free.front();
+    m_Free.pop_front();
+    m_CurrentRows = 0;
+    m_Thread = std::thread(&AsyncResultsWriter::Write, this);
+    return true;
+  }
+
+  bool IsOpen() const { return m_Current != nullptr; }
+
+  /// Copies a row of GetRowSize() values, the first one being the time
+  void Append(const double* row)
+  {
+    if (m_Current == nullptr)
+      return;
+    std::memcpy(&m_Current->rows[m_CurrentRows * m_RowSize], row, m_RowSize * sizeof(double));
+    if (++m_CurrentRows == m_RowsPerBlock)
+      Swap();
+  }
+
+  /// Writes the remaining rows, waits for the writer thread to finish and closes the file
+  void Close()
+  {
+    if (m_Current == nullptr)
+      return;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Current->numRows = m_CurrentRows;
+      m_Full.push_back(m_Current);
+      m_Current = nullptr;
+      m_Stop = true;
+    }
+    m_Signal.notify_all();
+    m_Thread.join();
+    m_Format->Close();
+  }
+
+  size_t GetRowSize() const { return m_RowSize; }
+  /// Number of times the simulation thread had to wait on the writer thread
+  size_t GetNumStalls() const { return m_Stalls; }
+
+protected:
+  struct Block
+  {
+    std::vector<double> rows;
+    size_t numRows;
+  };
+
+  // Hand the current block to the writer thread and take a free one
+  void Swap()
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Current->numRows = m_CurrentRows;
+    m_Full.push_back(m_Current);
+    m_Signal.notify_all();
+    if (m_Free.empty())
+    {
+      m_Stalls++;
+      m_Signal.wait(lock, [this] { return !m_Free.empty(); });
+    }
+    m_Current = m_Free.front();
+    m_Free.pop_front();
+    m_CurrentRows = 0;
+  }
+
+  void Write()
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (;;)
+    {
+      m_Signal.wait(lock, [this] { return m_Stop || !m_Full.empty(); });
+      if (m_Full.empty())
+        return;
+      Block* b = m_Full.front();
+      m_Full.pop_front();
+      // Format and write without holding the lock, the simulation thread keeps filling its block
+      lock.unlock();
+      m_Format->WriteBlock(b->rows.data(), b->numRows);
+      b->numRows = 0;
+      lock.lock();
+      m_Free.push_back(b);
+      m_Signal.notify_all();
+    }
+  }
+
+  std::unique_ptr<ResultsFormat> m_Format;
+  size_t m_RowsPerBlock;
+  size_t m_RowSize;
+  size_t m_NumBlocks;
+  std::vector<Block> m_Blocks;
+  Block* m_Current;       // Only used by the simulation thread
+  size_t m_CurrentRows;   // Only used by the simulation thread
+  size_t m_Stalls;
+  bool m_Stop;
+  std::deque<Block*> m_Free;
+  std::deque<Block*> m_Full;
+  std::mutex m_Mutex;
+  std::condition_variable m_Signal;
+  std::thread m_Thread;
+};
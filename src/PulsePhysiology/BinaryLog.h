@@ -0,0 +1,547 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "PhaseProfiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Log statements below this level are compiled out, 0 Debug, 1 Info, 2 Warning, 3 Error
+#ifndef SCENARIO_LOG_LEVEL
+#define SCENARIO_LOG_LEVEL 1
+#endif
+
+/// Structured binary log of the scenarios
+/// A log statement records the id of its format string, the source it logs for (i.e. an engine log)
+/// and its raw arguments in a ring buffer of the logging thread, nothing is formatted or allocated.
+/// A background thread moves the records of every thread to a single binary file, the messages are
+/// only formatted offline, with PulsePhysiologyLogDecode. Formats use {} for each argument, arguments are
+/// numbers, strings or units, anything else is formatted when it is logged.
+/// When a thread logs faster than its records are written, the records are dropped, logging never waits.
+/// When no binary log is open, log statements are formatted right away and sent to the engine logger.
+class BinaryLog
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+  static const size_t MaxRecordSize = 1024;
+
+  /// Starts writing the records of every thread to the given file
+  static bool Open(const std::string& filename) { return GetInstance().DoOpen(filename); }
+  /// Writes the remaining records and closes the file
+  static void Close() { GetInstance().DoClose(); }
+  static bool IsOpen() { return GetInstance().m_Open.load(std::memory_order_acquire); }
+  /// Number of records dropped because a thread logged faster than they could be written
+  static uint64_t GetNumDropped() { return GetInstance().m_Dropped.load(std::memory_order_relaxed); }
+
+  /// Called once per log statement, the returned id identifies the format in the file
+  static uint32_t RegisterFormat(int level, const char* format, const char* file, int line)
+  {
+    BinaryLog& log = GetInstance();
+    std::lock_guard<std::mutex> lock(log.m_TableMutex);
+    log.m_Formats.push_back({ level, line, file, format });
+    return static_cast<uint32_t>(log.m_Formats.size() - 1);
+  }
+
+  /// Names the records logged for the given key, i.e. the logger of an engine and its log file name
+  static void RegisterSource(const void* key, const std::string& name)
+  {
+    BinaryLog& log = GetInstance();
+    std::lock_guard<std::mutex> lock(log.m_TableMutex);
+    uint32_t id = static_cast<uint32_t>(log.m_Sources.size());
+    log.m_Sources.push_back(name);
+    log.m_SourceIds[key] = id;
+    log.m_SourceGeneration.fetch_add(1, std::memory_order_release);
+  }
+
+  /// Records a log statement, returns false if no binary log is open
+  template<typename... Args>
+  static bool Record(uint32_t format, const void* source, const Args&... args)
+  {
+    BinaryLog& log = GetInstance();
+    if (!log.m_Open.load(std::memory_order_acquire))
+      return false;
+
+    char record[MaxRecordSize];
+    size_t size = HeaderSize;
+    uint32_t sourceId = log.GetSourceId(source);
+    uint64_t time_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+    std::memcpy(record + 4, &format, 4);
+    std::memcpy(record + 8, &sourceId, 4);
+    std::memcpy(record + 12, &time_ns, 8);
+    Encode(record, size, args...);
+    uint32_t size32 = static_cast<uint32_t>(size);
+    std::memcpy(record, &size32, 4);
+
+    if (!log.GetThreadRing().Write(record, size))
+      log.m_Dropped.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// Formats a message right away, each {} of the format is replaced by the next argument
+  template<typename... Args>
+  static std::string Format(const char* format, const Args&... args)
+  {
+    std::stringstream ss;
+    FormatArgs(ss, format, args...);
+    return ss.str();
+  }
+
+  /// Decodes a binary log file to text, one line per record: time(s) source level message
+  static bool Decode(std::istream& in, std::ostream& out);
+
+private:
+  static const size_t HeaderSize = 20;  // size, format, source, time
+  static const size_t RingSize = 1 << 20;
+
+  struct FormatInfo
+  {
+    int level;
+    int line;
+    std::string file;
+    std::string format;
+  };
+
+  /// Single producer single consumer byte ring, the logging thread writes, the background thread reads
+  struct Ring
+  {
+    Ring() : head(0), tail(0), released(false) { }
+    bool Write(const char* data, size_t size)
+    {
+      size_t t = tail.load(std::memory_order_relaxed);
+      if (RingSize - (t - head.load(std::memory_order_acquire)) < size)
+        return false;
+      for (size_t i = 0; i < size; i++)
+        buffer[(t + i) & (RingSize - 1)] = data[i];
+      tail.store(t + size, std::memory_order_release);
+      return true;
+    }
+    /// Moves every complete record to out, returns the number of bytes moved
+    size_t Read(std::vector<char>& out)
+    {
+      size_t h = head.load(std::memory_order_relaxed);
+      size_t t = tail.load(std::memory_order_acquire);
+      for (size_t i = h; i < t; i++)
+        out.push_back(buffer[i & (RingSize - 1)]);
+      head.store(t, std::memory_order_release);
+      return t - h;
+    }
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<bool> released;  // Set once its thread ended, the writer recycles it when it is drained
+    char buffer[RingSize];
+  };
+
+  /// Owns the ring of a thread, and hands it back when the thread ends
+  struct RingOwner
+  {
+    ~RingOwner()
+    {
+      if (ring != nullptr)
+        ring->released.store(true, std::memory_order_release);
+    }
+    std::shared_ptr<Ring> ring;
+  };
+
+  BinaryLog() : m_Open(false), m_Stop(false), m_Dropped(0), m_SourceGeneration(0) { }
+  ~BinaryLog() { DoClose(); }
+
+  static BinaryLog& GetInstance()
+  {
+    static BinaryLog log;
+    return log;
+  }
+
+  static void Encode(char*, size_t&) { }
+  template<typename T, typename... Args>
+  static void Encode(char* record, size_t& size, const T& value, const Args&... args)
+  {
+    EncodeValue(record, size, value);
+    Encode(record, size, args...);
+  }
+  static void EncodeRaw(char* record, size_t& size, char tag, const void* data, size_t n)
+  {
+    if (size + 1 + n > MaxRecordSize)
+      return;
+    record[size++] = tag;
+    std::memcpy(record + size, data, n);
+    size += n;
+  }
+  static void EncodeValue(char* record, size_t& size, const char* value)
+  {
+    if (size + 3 > MaxRecordSize)
+      return;
+    uint16_t length = static_cast<uint16_t>(std::min(std::strlen(value), MaxRecordSize - size - 3));
+    record[size++] = 's';
+    std::memcpy(record + size, &length, 2);
+    std::memcpy(record + size + 2, value, length);
+    size += 2 + length;
+  }
+  static void EncodeValue(char* record, size_t& size, const std::string& value) { EncodeValue(record, size, value.c_str()); }
+  template<typename T>
+  static void EncodeValue(char* record, size_t& size, const T& value)
+  {
+    EncodeArg(record, size, value, std::is_arithmetic<T>());
+  }
+  template<typename T>
+  static void EncodeArg(char* record, size_t& size, const T& value, std::true_type)
+  {
+    if (std::is_floating_point<T>::value)
+    {
+      double v = static_cast<double>(value);
+      EncodeRaw(record, size, 'd', &v, 8);
+    }
+    else
+    {
+      int64_t v = static_cast<int64_t>(value);
+      EncodeRaw(record, size, 'i', &v, 8);
+    }
+  }
+  template<typename T>
+  static void EncodeArg(char* record, size_t& size, const T& value, std::false_type)
+  {
+    EncodeObject(record, size, value, 0);
+  }
+  // Units are recorded by name
+  template<typename T>
+  static auto EncodeObject(char* record, size_t& size, const T& value, int) -> decltype(value.GetString(), void())
+  {
+    EncodeValue(record, size, value.GetString());
+  }
+  // Anything else, i.e. a scalar with its unit, is formatted with its stream operator when it is logged
+  template<typename T>
+  static void EncodeObject(char* record, size_t& size, const T& value, long)
+  {
+    std::stringstream ss;
+    ss << value;
+    EncodeValue(record, size, ss.str());
+  }
+
+  static void FormatArgs(std::ostream& out, const char* format)
+  {
+    out << format;
+  }
+  template<typename T, typename... Args>
+  static void FormatArgs(std::ostream& out, const char* format, const T& value, const Args&... args)
+  {
+    const char* p = std::strstr(format, "{}");
+    if (p == nullptr)
+    {
+      out << format;
+      return;
+    }
+    out.write(format, p - format);
+    out << value;
+    FormatArgs(out, p + 2, args...);
+  }
+
+  uint32_t GetSourceId(const void* key)
+  {
+    // Engines keep logging for the same source, so the last one is cached on each thread,
+    // until a source is registered again, as a new engine may reuse the address of a deleted one
+    static thread_local const void* lastKey = nullptr;
+    static thread_local uint32_t lastId = 0;
+    static thread_local uint64_t lastGeneration = UINT64_MAX;
+    uint64_t generation = m_SourceGeneration.load(std::memory_order_acquire);
+    if (key == lastKey && generation == lastGeneration)
+      return lastId;
+    std::lock_guard<std::mutex> lock(m_TableMutex);
+    auto it = m_SourceIds.find(key);
+    lastKey = key;
+    lastId = it == m_SourceIds.end() ? UINT32_MAX : it->second;
+    lastGeneration = generation;
+    return lastId;
+  }
+
+  Ring& GetThreadRing()
+  {
+    // The ring is shared with the writer, so records logged right before the thread ends are still written,
+    // the writer then recycles it for the next thread, so short lived threads do not each leave a ring behind
+    static thread_local RingOwner owner;
+    if (owner.ring == nullptr)
+    {
+      std::lock_guard<std::mutex> lock(m_RingsMutex);
+      if (m_FreeRings.empty())
+        owner.ring = std::make_shared<Ring>();
+      else
+      {
+        owner.ring = m_FreeRings.back();
+        m_FreeRings.pop_back();
+        owner.ring->released.store(false, std::memory_order_relaxed);
+      }
+      m_Rings.push_back(owner.ring);
+    }
+    return *owner.ring;
+  }
+
+  // Moves the drained ring of a thread that ended to the free rings
+  void Recycle(const std::shared_ptr<Ring>& ring)
+  {
+    std::lock_guard<std::mutex> lock(m_RingsMutex);
+    m_Rings.erase(std::find(m_Rings.begin(), m_Rings.end(), ring));
+    m_FreeRings.push_back(ring);
+  }
+
+  bool DoOpen(const std::string& filename)
+  {
+    DoClose();
+    m_File.open(filename, std::ios::binary | std::ios::trunc);
+    if (!m_File)
+      return false;
+    m_File.write("PPBINLOG", 8);
+    uint32_t version = 1;
+    m_File.write(reinterpret_cast<const char*>(&version), 4);
+    m_WrittenFormats.clear();
+    m_WrittenSources.clear();
+    m_Stop = false;
+    m_Open.store(true, std::memory_order_release);
+    m_Writer = std::thread(&BinaryLog::Write, this);
+    return true;
+  }
+
+  void DoClose()
+  {
+    if (!m_Open.exchange(false))
+      return;
+    m_Stop = true;
+    m_Writer.join();
+    m_File.close();
+  }
+
+  void Write()
+  {
+    std::vector<char> bytes;
+    for (;;)
+    {
+      // Read the stop flag first, so the last drain sees every record logged before Close
+      bool stop = m_Stop.load();
+      std::vector<std::shared_ptr<Ring>> rings;
+      {
+        std::lock_guard<std::mutex> lock(m_RingsMutex);
+        rings = m_Rings;
+      }
+      bool any = false;
+      for (std::shared_ptr<Ring>& ring : rings)
+      {
+        // Read the flag first, once it is set the thread logged its last record
+        bool released = ring->released.load(std::memory_order_acquire);
+        bytes.clear();
+        if (ring->Read(bytes) > 0)
+        {
+          any = true;
+          WriteRecords(bytes);
+        }
+        if (released)
+          Recycle(ring);
+      }
+      if (stop)
+        break;
+      if (!any)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    m_File.flush();
+  }
+
+  void WriteRecords(const std::vector<char>& bytes)
+  {
+    for (size_t offset = 0; offset + HeaderSize <= bytes.size();)
+    {
+      uint32_t size, format, source;
+      std::memcpy(&size, &bytes[offset], 4);
+      std::memcpy(&format, &bytes[offset + 4], 4);
+      std::memcpy(&source, &bytes[offset + 8], 4);
+      // The format and source are written once, before their first record
+      if (m_WrittenFormats.insert(format).second)
+      {
+        FormatInfo info;
+        {
+          std::lock_guard<std::mutex> lock(m_TableMutex);
+          info = m_Formats[format];
+        }
+        m_File.put('F');
+        WriteInt(format);
+        WriteInt(static_cast<uint32_t>(info.level));
+        WriteInt(static_cast<uint32_t>(info.line));
+        WriteString(info.file);
+        WriteString(info.format);
+      }
+      if (source != UINT32_MAX && m_WrittenSources.insert(source).second)
+      {
+        std::string name;
+        {
+          std::lock_guard<std::mutex> lock(m_TableMutex);
+          name = m_Sources[source];
+        }
+        m_File.put('S');
+        WriteInt(source);
+        WriteString(name);
+      }
+      m_File.put('R');
+      m_File.write(&bytes[offset], size);
+      offset += size;
+    }
+  }
+
+  void WriteInt(uint32_t value) { m_File.write(reinterpret_cast<const char*>(&value), 4); }
+  void WriteString(const std::string& str)
+  {
+    WriteInt(static_cast<uint32_t>(str.size()));
+    m_File.write(str.data(), str.size());
+  }
+
+  std::atomic<bool> m_Open;
+  std::atomic<bool> m_Stop;
+  std::atomic<uint64_t> m_Dropped;
+  std::thread m_Writer;
+  std::ofstream m_File;
+
+  std::mutex m_TableMutex;  // Guards the formats and sources, only taken on registration and by the writer
+  std::vector<FormatInfo> m_Formats;
+  std::vector<std::string> m_Sources;
+  std::map<const void*, uint32_t> m_SourceIds;
+  std::atomic<uint64_t> m_SourceGeneration;
+
+  std::mutex m_RingsMutex;
+  std::vector<std::shared_ptr<Ring>> m_Rings;      // Of the threads that logged, drained by the writer
+  std::vector<std::shared_ptr<Ring>> m_FreeRings;  // Of the threads that ended, handed to the next threads to log
+
+  // Only used by the writer thread
+  std::set<uint32_t> m_WrittenFormats;
+  std::set<uint32_t> m_WrittenSources;
+};
+
+inline bool BinaryLog::Decode(std::istream& in, std::ostream& out)
+{
+  char magic[8];
+  uint32_t version = 0;
+  if (!in.read(magic, 8) || std::memcmp(magic, "PPBINLOG", 8) != 0 || !in.read(reinterpret_cast<char*>(&version), 4) || version != 1)
+    return false;
+
+  auto readInt = [&in]() { uint32_t v = 0; in.read(reinterpret_cast<char*>(&v), 4); return v; };
+  auto readString = [&in, &readInt]() { std::string s(readInt(), '\0'); if (!s.empty()) in.read(&s[0], s.size()); return s; };
+  static const char* levels[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+  std::map<uint32_t, FormatInfo> formats;
+  std::map<uint32_t, std::string> sources;
+  uint64_t start_ns = 0;
+  bool started = false;
+  std::vector<char> record;
+  char type;
+  while (in.get(type))
+  {
+    if (type == 'F')
+    {
+      uint32_t id = readInt();
+      FormatInfo& info = formats[id];
+      info.level = static_cast<int>(readInt());
+      info.line = static_cast<int>(readInt());
+      info.file = readString();
+      info.format = readString();
+    }
+    else if (type == 'S')
+    {
+      uint32_t id = readInt();
+      sources[id] = readString();
+    }
+    else if (type == 'R')
+    {
+      uint32_t size = readInt();
+      if (size < HeaderSize)
+        return false;
+      record.resize(size);
+      std::memcpy(record.data(), &size, 4);
+      if (!in.read(record.data() + 4, size - 4))
+        return false;
+      uint32_t format, source;
+      uint64_t time_ns;
+      std::memcpy(&format, &record[4], 4);
+      std::memcpy(&source, &record[8], 4);
+      std::memcpy(&time_ns, &record[12], 8);
+      if (!started)
+      {
+        start_ns = time_ns;
+        started = true;
+      }
+
+      const FormatInfo& info = formats[format];
+      out << std::fixed;
+      out.precision(6);
+      out << (time_ns - start_ns) * 1e-9 << " " << (sources.count(source) ? sources[source] : "-") << " "
+          << levels[info.level < 0 || info.level > 3 ? 1 : info.level] << " ";
+      out.unsetf(std::ios::floatfield);
+      out.precision(6);
+
+      // Replace each {} with the next argument
+      const char* f = info.format.c_str();
+      size_t offset = HeaderSize;
+      for (const char* p = std::strstr(f, "{}"); p != nullptr && offset < size; p = std::strstr(f, "{}"))
+      {
+        out.write(f, p - f);
+        f = p + 2;
+        char tag = record[offset++];
+        if ((tag == 'd' || tag == 'i') && offset + 8 > size)
+          break;
+        if (tag == 'd')
+        {
+          double v;
+          std::memcpy(&v, &record[offset], 8);
+          offset += 8;
+          out << v;
+        }
+        else if (tag == 'i')
+        {
+          int64_t v;
+          std::memcpy(&v, &record[offset], 8);
+          offset += 8;
+          out << v;
+        }
+        else if (tag == 's' && offset + 2 <= size)
+        {
+          uint16_t length;
+          std::memcpy(&length, &record[offset], 2);
+          if (offset + 2 + length > size)
+            break;
+          out.write(&record[offset + 2], length);
+          offset += 2 + length;
+        }
+        else
+          break;
+      }
+      out << f << "\n";
+    }
+    else
+      return false;
+  }
+  return true;
+}
+
+// Logs a formatted message for the given engine logger, to the binary log if one is open,
+// or else formatted right away by the engine logger. Statements below SCENARIO_LOG_LEVEL are compiled out.
+// The time spent logging is profiled as the Logger engine call, when the scenario is profiled.
+#define SCENARIO_LOG(level, method, logger, format, ...) \
+  do \
+  { \
+    if (level >= SCENARIO_LOG_LEVEL) \
+    { \
+      ScopedCallTimer scenarioLogTimer(EngineCall::Logger); \
+      static const uint32_t scenarioLogFormat = BinaryLog::RegisterFormat(level, format, __FILE__, __LINE__); \
+      if (!BinaryLog::Record(scenarioLogFormat, logger, ##__VA_ARGS__)) \
+        (logger)->method(BinaryLog::Format(format, ##__VA_ARGS__)); \
+    } \
+  } while (0)
+#define SCENARIO_LOG_DEBUG(logger, format, ...) SCENARIO_LOG(0, Debug, logger, format, ##__VA_ARGS__)
+#define SCENARIO_LOG_INFO(logger, format, ...) SCENARIO_LOG(1, Info, logger, format, ##__VA_ARGS__)
+#define SCENARIO_LOG_WARNING(logger, format, ...) SCENARIO_LOG(2, Warning, logger, format, ##__VA_ARGS__)
+#define SCENARIO_LOG_ERROR(logger, format, ...) SCENARIO_LOG(3, Error, logger, format, ##__VA_ARGS__)
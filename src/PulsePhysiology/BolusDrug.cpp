@@ -35,9 +35,9 @@
 void HowToBolusDrug()
 {
   // Create the engine and load the patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("BolusDrug.log");
-  pe->GetLogger()->Info("HowToBolusDrug");
-  if (!pe->LoadStateFile("./states/StandardMale@0s.pba"))
+  PooledEngine pe = CreateScenarioEngine("BolusDrug.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToBolusDrug");
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
   {
     pe->GetLogger()->Error("Could not load state, check the error");
     return;
@@ -60,13 +60,13 @@ void HowToBolusDrug()
 
   pe->GetEngineTracker()->GetDataRequestManager().SetResultsFilename("BolusDrug.csv");
 
-  pe->GetLogger()->Info("The patient is nice and healthy");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is nice and healthy");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
 
   tracker.AdvanceModelTime(50);
 
@@ -79,17 +79,18 @@ void HowToBolusDrug()
   bolus.GetDose().SetValue(20,VolumeUnit::mL);
   bolus.SetAdminRoute(cdm::eSubstanceAdministration_Route_Intravenous);
   // Pulse also supports Intramuscular as an admin route as well
-  pe->ProcessAction(bolus);
-  pe->GetLogger()->Info("Giving the patient Succinylcholine.");
+  tracker.ProcessAction(bolus);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Giving the patient Succinylcholine.");
 
   tracker.AdvanceModelTime(200);
 
-  pe->GetLogger()->Info("It has been 200s since the administration, not doing well...");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "It has been 200s since the administration, not doing well...");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Tidal Volume : {}{}", pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL), VolumeUnit::mL);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
\ No newline at end of file
@@ -42,10 +42,10 @@ void HowToBrainInjury()
 {
   std::stringstream ss;
   // Create a Pulse Engine and load the standard patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("BrainInjury.log");
+  PooledEngine pe = CreateScenarioEngine("BrainInjury.log");
   
-  pe->GetLogger()->Info("HowToBrainInjury");
-  if (!pe->LoadStateFile("./states/StandardMale@0s.pba"))
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToBrainInjury");
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
   {
     pe->GetLogger()->Error("Could not load state, check the error");
     return;
@@ -66,25 +66,25 @@ void HowToBrainInjury()
 
   pe->GetEngineTracker()->GetDataRequestManager().SetResultsFilename("rainInjury.csv");
 
-  pe->GetLogger()->Info("The patient is nice and healthy");
-  pe->GetLogger()->Info(std::stringstream() << "Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Carbon Dioxide Saturation : " << pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Intracranial Pressure : " << pe->GetCardiovascularSystem()->GetIntracranialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Cerebral Perfusion Pressure : " << pe->GetCardiovascularSystem()->GetCerebralPerfusionPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Cerebral Blood Flow : " << pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() << "Instantaneous GCS value : " << GlasgowEstimator(pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min)));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is nice and healthy");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carbon Dioxide Saturation : {}", pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Intracranial Pressure : {}{}", pe->GetCardiovascularSystem()->GetIntracranialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cerebral Perfusion Pressure : {}{}", pe->GetCardiovascularSystem()->GetCerebralPerfusionPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cerebral Blood Flow : {}{}", pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Instantaneous GCS value : {}", GlasgowEstimator(pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min)));
   // You can get the following pupillary effects
   // Reactivity Change in pupil recation time to light. -1 complete reduction/no response, 0 is normal, and 1 is the fastest reaction time.
   // Pupil size change from normal. -1 is fully constricted, 0 is no change, +1 is fully dilated.   
-  pe->GetLogger()->Info(std::stringstream() << "Left Eye Pupil Size Modifier : " << pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetSizeModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Left Eye Pupil Reactivity Modifier : " << pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetReactivityModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Right Eye Pupil Size Modifier : " << pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetSizeModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Right Eye Pupil Reactivity Modifier : " << pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetReactivityModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Left Eye Pupil Size Modifier : {}", pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetSizeModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Left Eye Pupil Reactivity Modifier : {}", pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetReactivityModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Right Eye Pupil Size Modifier : {}", pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetSizeModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Right Eye Pupil Reactivity Modifier : {}", pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetReactivityModifier());
 
   tracker.AdvanceModelTime(30);
   
@@ -93,89 +93,92 @@ void HowToBrainInjury()
   SEBrainInjury tbi;
   tbi.SetType(cdm::eBrainInjury_Type_Diffuse);// Can also be LeftFocal or RightFocal, and you will get pupillary effects in only one eye 
   tbi.GetSeverity().SetValue(0.2);
-  pe->ProcessAction(tbi);
-  pe->GetLogger()->Info("Giving the patient a brain injury.");
+  tracker.ProcessAction(tbi);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Giving the patient a brain injury.");
 
   // Advance time to see how the injury affects the patient
   tracker.AdvanceModelTime(90);
 
-  pe->GetLogger()->Info(std::stringstream() << "The patient has had a brain injury for 90s, not doing well...");
-  pe->GetLogger()->Info(std::stringstream() << "Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Carbon Dioxide Saturation : " << pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Intracranial Pressure : " << pe->GetCardiovascularSystem()->GetIntracranialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Cerebral Perfusion Pressure : " << pe->GetCardiovascularSystem()->GetCerebralPerfusionPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Cerebral Blood Flow : " << pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() << "Instantaneous GCS value : " << GlasgowEstimator(pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min)));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient has had a brain injury for 90s, not doing well...");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carbon Dioxide Saturation : {}", pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Intracranial Pressure : {}{}", pe->GetCardiovascularSystem()->GetIntracranialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cerebral Perfusion Pressure : {}{}", pe->GetCardiovascularSystem()->GetCerebralPerfusionPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cerebral Blood Flow : {}{}", pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Instantaneous GCS value : {}", GlasgowEstimator(pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min)));
   // You can get the following pupillary effects
   // Reactivity Change in pupil recation time to light. -1 complete reduction/no response, 0 is normal, and 1 is the fastest reaction time.
   // Pupil size change from normal. -1 is fully constricted, 0 is no change, +1 is fully dilated. 
-  pe->GetLogger()->Info(std::stringstream() << "Left Eye Pupil Size Modifier : " << pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetSizeModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Left Eye Pupil Reactivity Modifier : " << pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetReactivityModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Right Eye Pupil Size Modifier : " << pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetSizeModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Right Eye Pupil Reactivity Modifier : " << pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetReactivityModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Left Eye Pupil Size Modifier : {}", pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetSizeModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Left Eye Pupil Reactivity Modifier : {}", pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetReactivityModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Right Eye Pupil Size Modifier : {}", pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetSizeModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Right Eye Pupil Reactivity Modifier : {}", pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetReactivityModifier());
 
   // You can remove a brain injury by setting the severity to 0, this will instantly remove the flow resistance in the brain, and the patient will recover.
   tbi.GetSeverity().SetValue(0.0);
-  pe->ProcessAction(tbi);
+  tracker.ProcessAction(tbi);
+  tracker.SetPhase(ScenarioPhase::AfterIntervention);
 
-  pe->GetLogger()->Info("Removing the brain injury.");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Removing the brain injury.");
 
   tracker.AdvanceModelTime(90);
 
-  pe->GetLogger()->Info(std::stringstream() << "The patient's brain injury has been removed for 90s; patient is much better");
-  pe->GetLogger()->Info(std::stringstream() << "Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Carbon Dioxide Saturation : " << pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Intracranial Pressure : " << pe->GetCardiovascularSystem()->GetIntracranialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Cerebral Perfusion Pressure : " << pe->GetCardiovascularSystem()->GetCerebralPerfusionPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Cerebral Blood Flow : " << pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() << "Instantaneous GCS value : " << GlasgowEstimator(pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min)));// You can get the following pupillary effects
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient's brain injury has been removed for 90s; patient is much better");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carbon Dioxide Saturation : {}", pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Intracranial Pressure : {}{}", pe->GetCardiovascularSystem()->GetIntracranialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cerebral Perfusion Pressure : {}{}", pe->GetCardiovascularSystem()->GetCerebralPerfusionPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cerebral Blood Flow : {}{}", pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Instantaneous GCS value : {}", GlasgowEstimator(pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min)));// You can get the following pupillary effects
   // Reactivity Change in pupil recation time to light. -1 complete reduction/no response, 0 is normal, and 1 is the fastest reaction time.
   // Pupil size change from normal. -1 is fully constricted, 0 is no change, +1 is fully dilated. 
-  pe->GetLogger()->Info(std::stringstream() << "Left Eye Pupil Size Modifier : " << pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetSizeModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Left Eye Pupil Reactivity Modifier : " << pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetReactivityModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Right Eye Pupil Size Modifier : " << pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetSizeModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Right Eye Pupil Reactivity Modifier : " << pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetReactivityModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Left Eye Pupil Size Modifier : {}", pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetSizeModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Left Eye Pupil Reactivity Modifier : {}", pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetReactivityModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Right Eye Pupil Size Modifier : {}", pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetSizeModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Right Eye Pupil Reactivity Modifier : {}", pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetReactivityModifier());
 
   // A more severe injury has more pronounced effects
   tbi.GetSeverity().SetValue(1);
-  pe->ProcessAction(tbi);
-  pe->GetLogger()->Info("Giving the patient a severe brain injury.");
+  tracker.ProcessAction(tbi);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Giving the patient a severe brain injury.");
 
   tracker.AdvanceModelTime(300);
 
   // You can also get information from the compartment rather than the system, in case you want other metrics
   const SELiquidCompartment* brain = pe->GetCompartments().GetLiquidCompartment(pulse::VascularCompartment::Brain);
 
-  pe->GetLogger()->Info(std::stringstream() << "The patient has had a severe brain injury for 5 minutes");
-  pe->GetLogger()->Info(std::stringstream() << "Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() << "Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Carbon Dioxide Saturation : " << pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Intracranial Pressure : " << brain->GetPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Cerebral Perfusion Pressure : " << pe->GetCardiovascularSystem()->GetCerebralPerfusionPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() << "Cerebral Blood Flow : " << brain->GetInFlow(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() << "Instantaneous GCS value : " << GlasgowEstimator(pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min)));// You can get the following pupillary effects
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient has had a severe brain injury for 5 minutes");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Respiration Rate : {}bpm", pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carbon Dioxide Saturation : {}", pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Intracranial Pressure : {}{}", brain->GetPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cerebral Perfusion Pressure : {}{}", pe->GetCardiovascularSystem()->GetCerebralPerfusionPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cerebral Blood Flow : {}{}", brain->GetInFlow(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Instantaneous GCS value : {}", GlasgowEstimator(pe->GetCardiovascularSystem()->GetCerebralBloodFlow(VolumePerTimeUnit::mL_Per_min)));// You can get the following pupillary effects
   // Reactivity Change in pupil recation time to light. -1 complete reduction/no response, 0 is normal, and 1 is the fastest reaction time.
   // Pupil size change from normal. -1 is fully constricted, 0 is no change, +1 is fully dilated. 
-  pe->GetLogger()->Info(std::stringstream() << "Left Eye Pupil Size Modifier : " << pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetSizeModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Left Eye Pupil Reactivity Modifier : " << pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetReactivityModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Right Eye Pupil Size Modifier : " << pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetSizeModifier());
-  pe->GetLogger()->Info(std::stringstream() << "Right Eye Pupil Reactivity Modifier : " << pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetReactivityModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Left Eye Pupil Size Modifier : {}", pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetSizeModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Left Eye Pupil Reactivity Modifier : {}", pe->GetNervousSystem()->GetLeftEyePupillaryResponse()->GetReactivityModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Right Eye Pupil Size Modifier : {}", pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetSizeModifier());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Right Eye Pupil Reactivity Modifier : {}", pe->GetNervousSystem()->GetRightEyePupillaryResponse()->GetReactivityModifier());
 
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
 
 // The Glasgow Coma Scale (GCS) is commonly used to classify patient consciousness after traumatic brain injury.
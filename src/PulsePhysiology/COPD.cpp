@@ -23,6 +23,31 @@
 #include "properties/SEScalarVolumePerTime.h"
 #include "properties/SEScalar0To1.h"
 
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// The COPD condition applied to the patient in this how-to
+//--------------------------------------------------------------------------------------------------
+void SetupCOPD(SEChronicObstructivePulmonaryDisease& COPD)
+{
+  COPD.GetBronchitisSeverity().SetValue(0.5);
+  COPD.GetEmphysemaSeverity().SetValue(0.7);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Stabilizes the patient with the COPD condition and saves it to the stabilized state library
+//--------------------------------------------------------------------------------------------------
+void StabilizeCOPD()
+{
+  PooledEngine pe = CreateScenarioEngine("COPDStabilization.log");
+  SEChronicObstructivePulmonaryDisease COPD;
+  SetupCOPD(COPD);
+  std::vector<const SECondition*> conditions;
+  conditions.push_back(&COPD);
+  if (!InitializeEngineFromLibrary(*pe, "StandardMale.pba", conditions))
+    pe->GetLogger()->Error("Could not load initialize engine, check the error");
+}
+
 //--------------------------------------------------------------------------------------------------
 /// \brief
 /// Usage for applying a COPD condition to the patient
@@ -33,20 +58,20 @@
 void HowToCOPD()
 {
   // Create the engine and load the patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("COPD.log");
-  pe->GetLogger()->Info("HowToCOPD");
+  PooledEngine pe = CreateScenarioEngine("COPD.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToCOPD");
   
   // Since this is a condition, we do not provide a starting state
   // You will need to initialize the engine to this condition
-  // You could then save out your own state and use it in the future
+  // The stabilized state is saved in the state library the first time,
+  // following runs with the same condition parameters load it instead of stabilizing again
 
   SEChronicObstructivePulmonaryDisease COPD;
-  COPD.GetBronchitisSeverity().SetValue(0.5);
-  COPD.GetEmphysemaSeverity().SetValue(0.7);
+  SetupCOPD(COPD);
   std::vector<const SECondition*> conditions;
   conditions.push_back(&COPD);
 
-  if (!pe->InitializeEngine("StandardMale.pba", &conditions))
+  if (!InitializeEngineFromLibrary(*pe, "StandardMale.pba", conditions))
   {
     pe->GetLogger()->Error("Could not load initialize engine, check the error");
     return;
@@ -69,17 +94,23 @@ void HowToCOPD()
 
   pe->GetEngineTracker()->GetDataRequestManager().SetResultsFilename("COPD.csv");
 
+  // The condition is active from the start
+  tracker.SetPhase(ScenarioPhase::InsultActive);
+  // The patient was stabilized with the condition, the run can stop once the vitals settle
+  std::unique_ptr<SteadyStateStop> steadyState = SteadyStateStop::Create<SteadyStateVitals>(*pe);
+  tracker.AddStopCondition(*steadyState);
+
   // Advance some time to get some data
   tracker.AdvanceModelTime(500);
 
-  pe->GetLogger()->Info("The patient is not very healthy");
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() <<"Hemoglobin Content : " << pe->GetBloodChemistrySystem()->GetHemoglobinContent(MassUnit::g) << MassUnit::g);
-  pe->GetLogger()->Info(std::stringstream() <<"Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"InspiratoryExpiratoryRatio : " << pe->GetRespiratorySystem()->GetInspiratoryExpiratoryRatio());
-  pe->GetLogger()->Info(std::stringstream() <<"Carina InFlow : " << pe->GetCompartments().GetGasCompartment(pulse::PulmonaryCompartment::Carina)->GetInFlow(VolumePerTimeUnit::L_Per_s) << VolumePerTimeUnit::L_Per_s);;
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is not very healthy");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cardiac Output : {}{}", pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Hemoglobin Content : {}{}", pe->GetBloodChemistrySystem()->GetHemoglobinContent(MassUnit::g), MassUnit::g);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "InspiratoryExpiratoryRatio : {}", pe->GetRespiratorySystem()->GetInspiratoryExpiratoryRatio());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carina InFlow : {}{}", pe->GetCompartments().GetGasCompartment(pulse::PulmonaryCompartment::Carina)->GetInFlow(VolumePerTimeUnit::L_Per_s), VolumePerTimeUnit::L_Per_s);;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
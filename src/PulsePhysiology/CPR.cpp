@@ -43,15 +43,98 @@ public:
   MyListener(Logger* logger) : Loggable(logger) {};
   virtual void HandlePatientEvent(cdm::ePatient_Event type, bool active, const SEScalarTime* time) override
   {
-    GetLogger()->Info(std::stringstream() <<"Recieved Patient Event : " << cdm::ePatient_Event_Name(type));
+    SCENARIO_LOG_INFO(GetLogger(), "Recieved Patient Event : {}", cdm::ePatient_Event_Name(type));
   }
 
   virtual void HandleAnesthesiaMachineEvent(cdm::eAnesthesiaMachine_Event type, bool active, const SEScalarTime* time) override
   {
-    GetLogger()->Info(std::stringstream() <<"Recieved Anesthesia Machine Event : " << cdm::eAnesthesiaMachine_Event_Name(type));
+    SCENARIO_LOG_INFO(GetLogger(), "Recieved Anesthesia Machine Event : {}", cdm::eAnesthesiaMachine_Event_Name(type));
   }
 };
 
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Logs the cardiovascular values we check on during CPR
+//--------------------------------------------------------------------------------------------------
+void LogCardiovascularStatus(PhysiologyEngine& pe, VitalsReader& vitals)
+{
+  const VitalsSnapshot& v = vitals.Read();
+  SCENARIO_LOG_INFO(pe.GetLogger(), "Systolic Pressure : {}mmHg, Diastolic Pressure : {}mmHg, Heart Rate : {}bpm"
+                    ", Stroke Volume : {}mL, Cardiac Output : {}mL/min, Arterial Pressure : {}mmHg, Heart Ejection Fraction : {}",
+                    v.SystolicArterialPressure, v.DiastolicArterialPressure, v.HeartRate,
+                    v.HeartStrokeVolume, v.CardiacOutput, v.ArterialPressure, v.HeartEjectionFraction);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Creates the data requests written to the results file during CPR
+//--------------------------------------------------------------------------------------------------
+void CreateCPRDataRequests(PhysiologyEngine& pe, HowToTracker& tracker, const std::string& resultsFilename)
+{
+  // Create data requests for each value that should be written to the output log as the engine is executing
+  // Physiology System Names are defined on the System Objects 
+  // defined in the Physiology.xsd file
+  SEDataRequest& heartRate = pe.GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("HeartRate", FrequencyUnit::Per_min);
+  pe.GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("SystolicArterialPressure", PressureUnit::mmHg);
+  pe.GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("DiastolicArterialPressure", PressureUnit::mmHg);
+  pe.GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("MeanArterialPressure", PressureUnit::mmHg);
+  pe.GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("HeartStrokeVolume", VolumeUnit::mL);
+  pe.GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("HeartEjectionFraction");
+  pe.GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("CardiacOutput",VolumePerTimeUnit::mL_Per_min);
+  SEDataRequest& brainInFlow = pe.GetEngineTracker()->GetDataRequestManager().CreateLiquidCompartmentDataRequest(pulse::VascularCompartment::Brain, "InFlow", VolumePerTimeUnit::mL_Per_min);
+
+  pe.GetEngineTracker()->GetDataRequestManager().SetResultsFilename(resultsFilename);
+
+  // Every request is written at every time step, unless the results are decimated with --sample-period.
+  // Then the heart rate, only computed once per beat, is written at 1Hz at most, but we want to see the effect
+  // of each compression on the brain blood flow, so it is still written at every time step
+  double samplePeriod_s = ResultsSampler::GetDefaultSamplePeriod();
+  if (samplePeriod_s > 0)
+  {
+    tracker.SetSamplePeriod(heartRate, std::max(samplePeriod_s, 1.0));
+    tracker.SetSamplePeriod(brainInFlow, 0);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Administers CPR to a patient in cardiac arrest
+///
+/// \details
+/// The chest is compressed at the given rate and force, for percentOn of each compression period,
+/// until the compression that ends after the given duration. The chest is no longer compressed when this returns.
+/// Compressions are scheduled on exact time steps and run in a single step loop, so the rate and duty cycle do not drift.
+//--------------------------------------------------------------------------------------------------
+void PerformCPR(HowToTracker& tracker, double durationOfCPR_Seconds, double compressionRate_BeatsPerMinute,
+                double compressionForce_Newtons, double percentOn)
+{
+  // After patient's heart is not beating, start doing CPR
+  SEChestCompressionForce compression;
+  compression.GetForce().SetValue(compressionForce_Newtons, ForceUnit::N);
+  // The compression is removed by specifying the applied force as 0 N
+  SEChestCompressionForce release;
+  release.GetForce().SetValue(0, ForceUnit::N);
+
+  // The period is calculated via 1 / compressionRate.  Because the compression rate is given
+  // in beats per minute it is divided by 60 to give a period in seconds.
+  double pulsePeriod_s = 1.0 / (compressionRate_BeatsPerMinute / 60.0);
+
+  // The amount of time the chest will be compressed, calculated from the period and percentOn
+  double timeOn = percentOn * pulsePeriod_s;
+
+  // Schedule every compression and its release, the last compression is completed even if it ends after the duration
+  ActionTimeline cpr(tracker.GetTimeStep_s());
+  size_t numCompressions = static_cast<size_t>(std::ceil(durationOfCPR_Seconds / pulsePeriod_s));
+  for (size_t i = 0; i < numCompressions; i++)
+  {
+    cpr.Add(i * pulsePeriod_s, compression);
+    cpr.Add(i * pulsePeriod_s + timeOn, release);
+  }
+  cpr.SetDuration(numCompressions * pulsePeriod_s);
+
+  tracker.Run(cpr);
+}
+
 //--------------------------------------------------------------------------------------------------
 /// \brief
 /// Usage for adminstering CPR to a patient
@@ -65,9 +148,9 @@ public:
 void HowToCPR()
 {
   // Create the engine and load the patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("CPR.log");
-  pe->GetLogger()->Info("HowToCPR");
-  if (!pe->LoadStateFile("./states/StandardMale@0s.pba"))
+  PooledEngine pe = CreateScenarioEngine("CPR.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToCPR");
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
   {
     pe->GetLogger()->Error("Could not load state, check the error");
     return;
@@ -75,20 +158,12 @@ void HowToCPR()
 
   // The tracker is responsible for advancing the engine time and outputting the data requests below at each time step
   HowToTracker tracker(*pe);
+  // Reads the values we log in one pass
+  VitalsReader vitals(*pe);
+  tracker.AddVitalsReader(vitals);
 
   // Create data requests for each value that should be written to the output log as the engine is executing
-  // Physiology System Names are defined on the System Objects 
-  // defined in the Physiology.xsd file
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("HeartRate", FrequencyUnit::Per_min);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("SystolicArterialPressure", PressureUnit::mmHg);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("DiastolicArterialPressure", PressureUnit::mmHg);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("MeanArterialPressure", PressureUnit::mmHg);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("HeartStrokeVolume", VolumeUnit::mL);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("HeartEjectionFraction");
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("CardiacOutput",VolumePerTimeUnit::mL_Per_min);
-  pe->GetEngineTracker()->GetDataRequestManager().CreateLiquidCompartmentDataRequest(pulse::VascularCompartment::Brain, "InFlow", VolumePerTimeUnit::mL_Per_min);
-
-  pe->GetEngineTracker()->GetDataRequestManager().SetResultsFilename("CPR.csv");
+  CreateCPRDataRequests(*pe, tracker, "CPR.csv");
 
   // This is the total amount of time that CPR will be administered in seconds
   double durationOfCPR_Seconds = 120;
@@ -103,111 +178,39 @@ void HowToCPR()
   // (60 beats per minute) the chest will be compressed for 0.3 seconds
   double percentOn = .3;
 
-  pe->GetLogger()->Info("The patient is nice and healthy");
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Stroke Volume : " << pe->GetCardiovascularSystem()->GetHeartStrokeVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() <<"Arterial Pressure : " << pe->GetCardiovascularSystem()->GetArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Ejection Fraction : " << pe->GetCardiovascularSystem()->GetHeartEjectionFraction());;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is nice and healthy");
+  LogCardiovascularStatus(*pe, vitals);
 
   tracker.AdvanceModelTime(50);
 
   // Put the patient into cardiac arrest
   SECardiacArrest c;
   c.SetState(cdm::eSwitch::On);
-  pe->ProcessAction(c);
+  tracker.ProcessAction(c);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
   
-  pe->GetLogger()->Info("Giving the patient Cardiac Arrest.");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Giving the patient Cardiac Arrest.");
 
   // Let's add a listener which will print any state changes that patient undergoes
+  // The run stops if the patient reaches an irreversible state, the events are forwarded to the listener
   MyListener l(pe->GetLogger());
-  pe->GetPatient().ForwardEvents(&l);
+  PatientEventStop irreversible(&l);
+  irreversible.Add(cdm::ePatient_Event_IrreversibleState);
+  tracker.AddStopCondition(irreversible);
+  tracker.ForwardEvents(&irreversible);
   
   tracker.AdvanceModelTime(10);
 
-  pe->GetLogger()->Info("It has been 10s since the administration, not doing well...");
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Stroke Volume : " << pe->GetCardiovascularSystem()->GetHeartStrokeVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() <<"Arterial Pressure : " << pe->GetCardiovascularSystem()->GetArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Ejection Fraction : " << pe->GetCardiovascularSystem()->GetHeartEjectionFraction());;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "It has been 10s since the administration, not doing well...");
+  LogCardiovascularStatus(*pe, vitals);
 
 
-  // After patient's heart is not beating, start doing CPR
-  SEChestCompressionForce chestCompression;
-
-  // The period is calculated via 1 / compressionRate.  Because the compression rate is given
-  // in beats per minute it is divided by 60 to give a period in seconds.
-  double pulsePeriod_s = 1.0 / (compressionRate_BeatsPerMinute / 60.0);
-
-  // The amount of time the chest will be compressed, calculated from the period and percentOn
-  double timeOn = percentOn * pulsePeriod_s;
-
-  // The rest of the time there will be no force on the chest, this is calculated from the
-  double timeOff = pulsePeriod_s - timeOn;
-
-  // This timer is used to keep track of how long CPR has been administered
-  double timer1 = 0;
-
-  // This boolean is used to determine if the chest is compressed or not. It starts as true
-  // so the chest will be compressed on the next calculation from the engine.
-  bool pulseState = true;
-  
-  pe->GetLogger()->Info("Patient is in asystole. Begin performing CPR");
-  while (timer1 < durationOfCPR_Seconds) // CPR is administered in this loop. It is time based, so after timer1 has exceeded the specified duration of CPR it will stop. set pulseState to true so that it will only exit AFTER a compression has been removed
-  {
-    if (pulseState) // check if the chest is supposed to be compressed. If yes...
-    {
-            // This calls the CPR function in the Cardiovascular system.  It sets the chest compression at the specified force.
-      chestCompression.GetForce().SetValue(compressionForce_Newtons, ForceUnit::N);
-      pe->ProcessAction(chestCompression);
-
-            // Time is advanced until it is time to remove the compression
-      tracker.AdvanceModelTime(timeOn);
-            
-            // Increment timer1 by the time the chest was compressed
-      timer1 += timeOn;
-
-            // Specify that the compression is to now be removed.
-      pulseState = false;
-    }
-    else
-    {
-            // This removes the chest compression by specifying the applied force as 0 N
-      chestCompression.GetForce().SetValue(0, ForceUnit::N);
-      pe->ProcessAction(chestCompression);
-            
-            // Time is advanced until it is time to compress the chest again
-      tracker.AdvanceModelTime(timeOff);
-            
-            // Increment timer1 by the time the chest was no compressed
-      timer1 += timeOff;
-
-            // Set pulse state back to true.
-      pulseState = true;
-    }
-  }
-
-  // Make sure that the chest is no longer being compressed
-  if (chestCompression.GetForce().GetValue(ForceUnit::N) != 0)
-  {
-        // If it is compressed, set force to 0 to turn off
-    chestCompression.GetForce().SetValue(0, ForceUnit::N);
-    pe->ProcessAction(chestCompression);
-  }
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Patient is in asystole. Begin performing CPR");
+  tracker.SetPhase(ScenarioPhase::AfterIntervention);
+  PerformCPR(tracker, durationOfCPR_Seconds, compressionRate_BeatsPerMinute, compressionForce_Newtons, percentOn);
 
   // Do one last output to show status after CPR.
-  pe->GetLogger()->Info("Check on the patient's status after CPR has been performed");
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Stroke Volume : " << pe->GetCardiovascularSystem()->GetHeartStrokeVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() <<"Arterial Pressure : " << pe->GetCardiovascularSystem()->GetArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Ejection Fraction : " << pe->GetCardiovascularSystem()->GetHeartEjectionFraction());
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Check on the patient's status after CPR has been performed");
+  LogCardiovascularStatus(*pe, vitals);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Usage for driving CPR from a manikin force sensor
+///
+/// \details
+/// A sensor thread stands in for the manikin: it samples the compression force at 1kHz and pushes it to a
+/// DeviceInputQueue, the engine runs in real time and applies the latest force before each time step.
+/// The age of the applied forces is written to the log at the end.
+//--------------------------------------------------------------------------------------------------
+void HowToCPRManikin()
+{
+  // Create the engine and load the patient
+  PooledEngine pe = CreateScenarioEngine("CPRManikin.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToCPRManikin");
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
+  {
+    pe->GetLogger()->Error("Could not load state, check the error");
+    return;
+  }
+
+  HowToTracker tracker(*pe);
+  VitalsReader vitals(*pe);
+  tracker.AddVitalsReader(vitals);
+  CreateCPRDataRequests(*pe, tracker, "CPRManikin.csv");
+
+  tracker.AdvanceModelTime(50);
+
+  SECardiacArrest c;
+  c.SetState(cdm::eSwitch::On);
+  tracker.ProcessAction(c);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Giving the patient Cardiac Arrest.");
+  tracker.AdvanceModelTime(10);
+  LogCardiovascularStatus(*pe, vitals);
+
+  // The sensor and the engine have to share the wall clock
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Patient is in asystole. Begin performing CPR on the manikin");
+  tracker.SetPhase(ScenarioPhase::AfterIntervention);
+  tracker.SetRealTime(true);
+  std::unique_ptr<DeviceInputQueue> inputs(new DeviceInputQueue());
+  tracker.SetInputQueue(inputs.get());
+
+  // Compressions at 100 per minute, a half sine of 400N for 30% of each compression
+  std::atomic<bool> compressing(true);
+  std::thread sensor([&inputs, &compressing]()
+  {
+    const double pi = 3.14159265358979323846;
+    const double period_s = 60.0 / 100.0;
+    const double timeOn_s = 0.3 * period_s;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point next = start;
+    while (compressing)
+    {
+      double t = std::fmod(std::chrono::duration<double>(next - start).count(), period_s);
+      inputs->Push(DeviceInput::ChestCompressionForce, t < timeOn_s ? 400 * std::sin(pi * t / timeOn_s) : 0);
+      next += std::chrono::milliseconds(1);
+      std::this_thread::sleep_until(next);
+    }
+  });
+
+  tracker.AdvanceModelTime(30);
+
+  compressing = false;
+  sensor.join();
+  tracker.SetInputQueue(nullptr);
+  SEChestCompressionForce release;
+  release.GetForce().SetValue(0, ForceUnit::N);
+  tracker.ProcessAction(release);
+
+  const LatencyHistogram& age = inputs->GetInputAge();
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Manikin inputs applied : {}, superseded : {}, dropped : {}, age p50 : {}ms, p99 : {}ms, max : {}ms",
+                    age.GetCount(), inputs->GetNumSuperseded(), inputs->GetNumDropped(),
+                    age.GetPercentile_s(0.5) * 1e3, age.GetPercentile_s(0.99) * 1e3, age.GetMax_s() * 1e3);
+
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Check on the patient's status after CPR has been performed");
+  LogCardiovascularStatus(*pe, vitals);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
+}
@@ -0,0 +1,101 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+
+#include "EngineFork.h"
+#include "JobPool.h"
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Sweeps the CPR parameters from a single cardiac arrest
+///
+/// \details
+/// The patient is warmed up and put in cardiac arrest once, then every combination of compression
+/// force, rate and duty cycle is forked from that point and run in parallel.
+/// Variant i writes its results to CPRSweep_<i>.csv and its log to CPRSweep_<i>.log,
+/// the parameters of each variant are listed in CPRSweep.log.
+//--------------------------------------------------------------------------------------------------
+void HowToCPRSweep()
+{
+  // Create the engine and load the patient
+  PooledEngine pe = CreateScenarioEngine("CPRSweep.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToCPRSweep");
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
+  {
+    pe->GetLogger()->Error("Could not load state, check the error");
+    return;
+  }
+
+  // The prefix shared by every variant, nothing is written to the results
+  {
+    HowToTracker tracker(*pe);
+    VitalsReader vitals(*pe);
+    tracker.AddVitalsReader(vitals);
+    tracker.AdvanceModelTime(50);
+
+    SECardiacArrest c;
+    c.SetState(cdm::eSwitch::On);
+    tracker.ProcessAction(c);
+    tracker.SetPhase(ScenarioPhase::InsultActive);
+    SCENARIO_LOG_INFO(pe->GetLogger(), "Giving the patient Cardiac Arrest.");
+
+    tracker.AdvanceModelTime(10);
+    LogCardiovascularStatus(*pe, vitals);
+  }
+  EngineSnapshot arrest(*pe);
+  if (!arrest.IsValid())
+  {
+    pe->GetLogger()->Error("Could not save the cardiac arrest state, check the error");
+    return;
+  }
+
+  struct Variant
+  {
+    double force_N;
+    double rate_bpm;
+    double percentOn;
+  };
+  std::vector<Variant> variants;
+  for (double force_N : { 200.0, 300.0, 400.0, 500.0, 600.0 })
+    for (double rate_bpm : { 80.0, 100.0, 120.0 })
+      for (double percentOn : { 0.3, 0.5 })
+        variants.push_back({ force_N, rate_bpm, percentOn });
+
+  double durationOfCPR_Seconds = 120;
+  // One engine per thread available to this scenario, the variants all cost the same
+  // Run along other scenarios, the sweep only gets its share of the cores
+  JobPool pool;
+  // The variants run on other threads, they record their files, profile and metrics in the ones of the scenario
+  ScenarioContext context;
+  for (size_t i = 0; i < variants.size(); i++)
+  {
+    const Variant& v = variants[i];
+    SCENARIO_LOG_INFO(pe->GetLogger(), "CPRSweep_{} : {}N at {}bpm, compressed {}% of the time",
+                      i, v.force_N, v.rate_bpm, v.percentOn * 100);
+    pool.Add([&arrest, &context, v, i, durationOfCPR_Seconds]()
+    {
+      ScenarioContext::Scope scope(context);
+      std::string name = "CPRSweep_" + std::to_string(i);
+      PooledEngine branch = arrest.Fork(name + ".log");
+      if (branch == nullptr)
+        return;
+
+      HowToTracker tracker(*branch);
+      VitalsReader vitals(*branch);
+      tracker.AddVitalsReader(vitals);
+      CreateCPRDataRequests(*branch, tracker, name + ".csv");
+      MyListener l(branch->GetLogger());
+      PatientEventStop irreversible(&l);
+      irreversible.Add(cdm::ePatient_Event_IrreversibleState);
+      tracker.AddStopCondition(irreversible);
+      tracker.ForwardEvents(&irreversible);
+
+      tracker.SetPhase(ScenarioPhase::AfterIntervention);
+      PerformCPR(tracker, durationOfCPR_Seconds, v.rate_bpm, v.force_N, v.percentOn);
+
+      SCENARIO_LOG_INFO(branch->GetLogger(), "Check on the patient's status after CPR has been performed");
+      LogCardiovascularStatus(*branch, vitals);
+    }, durationOfCPR_Seconds);
+  }
+  pool.Run();
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
+}
@@ -0,0 +1,21 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class PhysiologyEngine;
+
+/// Channels sampled straight from the engine rather than through data requests, i.e. a TypedSampler
+class ChannelSource
+{
+public:
+  virtual ~ChannelSource() { }
+  /// Called once, before the first sample, returns false if a channel could not be found
+  virtual bool Setup(PhysiologyEngine& pe) = 0;
+  virtual size_t GetNumChannels() const = 0;
+  virtual std::string GetChannelName(size_t channel) const = 0;
+  /// Writes the value of each channel
+  virtual void Sample(double time_s, double* values) = 0;
+};
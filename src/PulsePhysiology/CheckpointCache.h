@@ -0,0 +1,213 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "scenario/SEAction.h"
+#include "system/physiology/SECardiovascularSystem.h"
+#include "properties/SEScalarFrequency.h"
+#include "properties/SEScalarTime.h"
+#include "ContentHash.h"
+#include "ScenarioMetrics.h"
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+/// Removes the data requests from a state, so that loading it does not replace the requests of the engine
+inline void StripDataRequests(google::protobuf::Message& state)
+{
+  const google::protobuf::FieldDescriptor* field = state.GetDescriptor()->FindFieldByName("DataRequestManager");
+  if (field != nullptr)
+    state.GetReflection()->ClearField(&state, field);
+}
+
+/// Disk cache of engine states along the timeline of a scenario
+/// The key of a checkpoint is a hash of the Pulse version, the state the engine started from,
+/// and every action processed and time advanced since, in order. When a scenario advances time,
+/// if a checkpoint exists for the timeline up to the end of that advance, the engine is loaded from it
+/// instead of computing the time steps. So a re-run that only changes later actions, i.e. the time of a
+/// needle decompression, loads the shared part of the timeline and only computes what changed.
+/// A checkpoint is saved every interval of simulated time the engine actually computed.
+/// Actions must go through the tracker to be part of the key. The tracker saves the results rows and events
+/// of the advance that ends at a checkpoint next to it, see GetSegmentFile, and replays them when it resumes.
+/// Checkpoints are binary protobuf .pb files, parsed here and loaded from memory, the engine only reads text .pba files.
+class ScenarioCheckpoints
+{
+public:
+  ScenarioCheckpoints(PhysiologyEngine& engine) : m_Engine(engine), m_Interval_s(GetDefaultInterval_s()), m_Uncached_s(0)
+  {
+    m_Key.Add(std::string(PULSE_PHYSIOLOGY_PULSE_VERSION));
+    std::unique_ptr<google::protobuf::Message> state = m_Engine.SaveState();
+    if (state != nullptr)
+    {
+      StripDataRequests(*state);
+      m_Key.Add(state->SerializeAsString());
+      // Checkpoints are parsed into new messages of the type of the engine state
+      m_Prototype.reset(state->New());
+    }
+  }
+
+  /// Whether new trackers use checkpoints
+  static bool& GetDefaultEnabled()
+  {
+    static bool enabled = false;
+    return enabled;
+  }
+  /// The simulated time computed between two checkpoints of new trackers
+  static double& GetDefaultInterval_s()
+  {
+    static double interval_s = 10;
+    return interval_s;
+  }
+  /// The directory checkpoints are saved to, shared by every scenario
+  static std::string& GetDirectory()
+  {
+    static std::string directory = "./checkpoints/";
+    return directory;
+  }
+
+  /// Adds an action to the timeline
+  void AddAction(const SEAction& action)
+  {
+    std::stringstream ss;
+    action.ToString(ss);
+    m_Key.Add(ss.str());
+  }
+
+  /// Adds an action scheduled on the given time step of the next advance to the timeline
+  void AddActionAtStep(size_t step, const SEAction& action)
+  {
+    uint64_t n = step;
+    m_Key.Add(&n, sizeof(n));
+    AddAction(action);
+  }
+
+  /// Adds an advance of the given number of time steps to the timeline
+  void AddAdvance(size_t steps)
+  {
+    uint64_t n = steps;
+    m_Key.Add(&n, sizeof(n));
+  }
+
+  /// Whether a checkpoint exists for the timeline so far
+  bool IsSaved() const { return std::ifstream(GetFile()).good(); }
+
+  /// Loads the engine from the checkpoint of the timeline so far, returns false if there is none
+  bool Resume()
+  {
+    std::string file = GetFile();
+    if (!std::ifstream(file).good())
+      return false;
+    ScopedMetric metric(&ScenarioMetrics::stateLoad_s);
+    if (!Load(file))
+    {
+      m_Engine.GetLogger()->Warning("Unable to load checkpoint " + file + ", computing the time steps again");
+      return false;
+    }
+    m_Engine.GetLogger()->Info("Resumed from checkpoint " + file);
+    m_Uncached_s = 0;
+    return true;
+  }
+
+  /// Call once the time steps of an advance that was not resumed are computed,
+  /// saves a checkpoint if enough time was computed since the last one
+  void Computed(double duration_s)
+  {
+    m_Uncached_s += duration_s;
+    if (m_Uncached_s < m_Interval_s)
+      return;
+    m_Uncached_s = 0;
+
+    std::string file = GetFile();
+    if (!Save(file))
+      m_Engine.GetLogger()->Warning("Unable to save checkpoint " + file);
+  }
+
+  /// Checks that a checkpoint loads back into the engine it was saved from: saves one after the given
+  /// number of time steps, computes as many more, resumes from the checkpoint and compares the heart rate
+  static bool CheckRoundTrip(PhysiologyEngine& pe, size_t steps = 50)
+  {
+    ScenarioCheckpoints checkpoints(pe);
+    for (size_t i = 0; i < steps; i++)
+      pe.AdvanceModelTime();
+    double time_s = pe.GetSimulationTime(TimeUnit::s);
+    double heartRate = pe.GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min);
+    std::string file = GetDirectory() + "RoundTrip.pb";
+    if (!checkpoints.Save(file))
+      return false;
+    for (size_t i = 0; i < steps; i++)
+      pe.AdvanceModelTime();
+    bool loaded = checkpoints.Load(file);
+    std::remove(file.c_str());
+    if (!loaded)
+      return false;
+    return std::abs(pe.GetSimulationTime(TimeUnit::s) - time_s) < 1e-9 &&
+           std::abs(pe.GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) - heartRate) <= 1e-6 * std::abs(heartRate);
+  }
+
+  std::string GetFile() const { return GetDirectory() + m_Key.ToString() + ".pb"; }
+  /// A file saved along the checkpoint of the timeline so far, i.e. the results of the advance that ends at it
+  std::string GetSegmentFile(const std::string& extension) const { return GetDirectory() + m_Key.ToString() + "." + extension; }
+
+protected:
+  // Saves the state of the engine, without its data requests, to the given file
+  bool Save(const std::string& file)
+  {
+    std::unique_ptr<google::protobuf::Message> state = m_Engine.SaveState();
+    if (state == nullptr)
+      return false;
+    StripDataRequests(*state);
+    // Save to a temporary file first, so another process never reads a partially written checkpoint
+    std::string tmpFile = file + ".tmp";
+    MakeDirectory(GetDirectory());
+    bool saved;
+    {
+      std::ofstream out(tmpFile, std::ios::binary);
+      saved = state->SerializeToOstream(&out);
+    }
+    if (!saved || std::rename(tmpFile.c_str(), file.c_str()) != 0)
+    {
+      std::remove(tmpFile.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  // Parses a state saved by Save and loads it into the engine
+  bool Load(const std::string& file)
+  {
+    if (m_Prototype == nullptr)
+      return false;
+    std::unique_ptr<google::protobuf::Message> state(m_Prototype->New());
+    std::ifstream in(file, std::ios::binary);
+    if (!in.good() || !state->ParseFromIstream(&in))
+      return false;
+    return m_Engine.LoadState(*state);
+  }
+
+  static void MakeDirectory(const std::string& directory)
+  {
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+  }
+
+  PhysiologyEngine& m_Engine;
+  std::unique_ptr<google::protobuf::Message> m_Prototype; // Empty message of the type of the engine state
+  ContentHash m_Key;       // Hash of the timeline so far
+  double m_Interval_s;
+  double m_Uncached_s;     // Simulated time computed since the last checkpoint
+};
@@ -0,0 +1,195 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+
+#include "ColumnarResults.h"
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ColumnarResults
+{
+  void WriteHeader(std::ostream& out, const std::vector<std::string>& columnNames)
+  {
+    size_t size = sizeof(Magic) + 2 * sizeof(uint32_t);
+    out.write(Magic, sizeof(Magic));
+    uint32_t value = Version;
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    value = static_cast<uint32_t>(columnNames.size());
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    for (const std::string& name : columnNames)
+    {
+      value = static_cast<uint32_t>(name.size());
+      out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+      out.write(name.data(), name.size());
+      size += sizeof(value) + name.size();
+    }
+    // Keep the values 8 byte aligned, so the reader can use them in place
+    static const char padding[8] = { 0 };
+    out.write(padding, (8 - size % 8) % 8);
+  }
+
+  void WriteBlock(std::ostream& out, const double* rows, size_t numRows, size_t numColumns)
+  {
+    if (numRows == 0)
+      return;
+    uint64_t n = numRows;
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    std::vector<double> column(numRows);
+    for (size_t c = 0; c < numColumns; c++)
+    {
+      for (size_t r = 0; r < numRows; r++)
+        column[r] = rows[r * numColumns + c];
+      out.write(reinterpret_cast<const char*>(column.data()), numRows * sizeof(double));
+    }
+  }
+
+  Reader::Reader() : m_Data(nullptr), m_Size(0), m_NumRows(0) { }
+  Reader::~Reader() { Close(); }
+
+  bool Reader::Open(const std::string& filename)
+  {
+    Close();
+#ifdef _WIN32
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+      return false;
+    m_Buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_Data = m_Buffer.data();
+    m_Size = m_Buffer.size();
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+      close(fd);
+      return false;
+    }
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+      return false;
+    m_Data = static_cast<const char*>(data);
+    m_Size = static_cast<size_t>(st.st_size);
+#endif
+
+    // Parse the header
+    size_t offset = sizeof(Magic) + 2 * sizeof(uint32_t);
+    uint32_t version, numColumns;
+    if (m_Size < offset || std::memcmp(m_Data, Magic, sizeof(Magic)) != 0)
+    {
+      Close();
+      return false;
+    }
+    std::memcpy(&version, m_Data + sizeof(Magic), sizeof(version));
+    std::memcpy(&numColumns, m_Data + sizeof(Magic) + sizeof(version), sizeof(numColumns));
+    // Sizes computed from the header must not wrap around, even for a corrupt file
+    if (version != Version || numColumns > SIZE_MAX / sizeof(double))
+    {
+      Close();
+      return false;
+    }
+    for (uint32_t c = 0; c < numColumns; c++)
+    {
+      uint32_t length;
+      if (offset + sizeof(length) > m_Size)
+      {
+        Close();
+        return false;
+      }
+      std::memcpy(&length, m_Data + offset, sizeof(length));
+      offset += sizeof(length);
+      if (offset + length > m_Size)
+      {
+        Close();
+        return false;
+      }
+      m_ColumnNames.push_back(std::string(m_Data + offset, length));
+      offset += length;
+    }
+    offset += (8 - offset % 8) % 8;
+
+    // Index the blocks, only their sizes are read
+    size_t rowSize = static_cast<size_t>(numColumns) * sizeof(double);
+    while (offset + sizeof(uint64_t) <= m_Size)
+    {
+      uint64_t numRows;
+      std::memcpy(&numRows, m_Data + offset, sizeof(numRows));
+      offset += sizeof(numRows);
+      // Compare the rows to what is left of the file before multiplying, a corrupt count could wrap the block size around
+      if (rowSize != 0 && numRows > (m_Size - offset) / rowSize)
+        break;// Truncated block, the file is still being written or the writer did not finish
+      size_t blockSize = static_cast<size_t>(numRows) * rowSize;
+      Block b;
+      b.numRows = static_cast<size_t>(numRows);
+      b.values = reinterpret_cast<const double*>(m_Data + offset);
+      m_Blocks.push_back(b);
+      m_NumRows += b.numRows;
+      offset += blockSize;
+    }
+    return true;
+  }
+
+  void Reader::Close()
+  {
+#ifdef _WIN32
+    m_Buffer.clear();
+#else
+    if (m_Data != nullptr)
+      munmap(const_cast<char*>(m_Data), m_Size);
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+    m_NumRows = 0;
+    m_ColumnNames.clear();
+    m_Blocks.clear();
+  }
+
+  int Reader::GetColumnIndex(const std::string& name) const
+  {
+    for (size_t c = 0; c < m_ColumnNames.size(); c++)
+    {
+      if (m_ColumnNames[c] == name)
+        return static_cast<int>(c);
+    }
+    return -1;
+  }
+
+  const double* Reader::GetBlockColumn(size_t block, size_t column) const
+  {
+    const Block& b = m_Blocks[block];
+    return b.values + column * b.numRows;
+  }
+
+  bool Reader::ReadColumn(size_t column, std::vector<double>& values) const
+  {
+    if (column >= m_ColumnNames.size())
+      return false;
+    values.clear();
+    values.reserve(m_NumRows);
+    for (size_t b = 0; b < m_Blocks.size(); b++)
+    {
+      const double* v = GetBlockColumn(b, column);
+      values.insert(values.end(), v, v + m_Blocks[b].numRows);
+    }
+    return true;
+  }
+
+  bool Reader::ReadColumn(const std::string& name, std::vector<double>& values) const
+  {
+    int column = GetColumnIndex(name);
+    if (column < 0)
+      return false;
+    return ReadColumn(static_cast<size_t>(column), values);
+  }
+}
@@ -0,0 +1,79 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// Binary columnar results file
+///
+/// The file starts with a header describing the columns, built from the data requests of the engine:
+///   char[8]  magic "PPCOLRES"
+///   uint32   version
+///   uint32   number of columns, the first column is the time in seconds
+///   for each column : uint32 name length, followed by the name (i.e. HeartRate(1/min))
+///   zero padding up to a multiple of 8 bytes
+/// It is followed by blocks of rows, stored column by column:
+///   uint64   number of rows in the block
+///   for each column : number of rows float64 values
+/// Values are stored in the native byte order, channels that were not sampled in a row are NaN.
+/// A reader can get to any column of any block from the block sizes only, without parsing any value.
+namespace ColumnarResults
+{
+  static const char     Magic[8] = { 'P', 'P', 'C', 'O', 'L', 'R', 'E', 'S' };
+  static const uint32_t Version = 1;
+
+  /// Writes the file header, columnNames includes the time column
+  void WriteHeader(std::ostream& out, const std::vector<std::string>& columnNames);
+  /// Writes a block of row major values, each row holding one value per column
+  void WriteBlock(std::ostream& out, const double* rows, size_t numRows, size_t numColumns);
+
+  /// Read only view of a binary columnar results file, the file is memory mapped,
+  /// so only the pages of the columns that are actually read are loaded from disk
+  class Reader
+  {
+  public:
+    Reader();
+    ~Reader();
+
+    bool Open(const std::string& filename);
+    void Close();
+    bool IsOpen() const { return m_Data != nullptr; }
+
+    size_t GetNumColumns() const { return m_ColumnNames.size(); }
+    size_t GetNumRows() const { return m_NumRows; }
+    const std::vector<std::string>& GetColumnNames() const { return m_ColumnNames; }
+    /// Returns the index of the given column, or -1 if there is no such column
+    int GetColumnIndex(const std::string& name) const;
+
+    size_t GetNumBlocks() const { return m_Blocks.size(); }
+    size_t GetBlockNumRows(size_t block) const { return m_Blocks[block].numRows; }
+    /// Direct pointer to the values of a column in a block, valid until the reader is closed
+    const double* GetBlockColumn(size_t block, size_t column) const;
+
+    /// Copies a whole column
+    bool ReadColumn(size_t column, std::vector<double>& values) const;
+    bool ReadColumn(const std::string& name, std::vector<double>& values) const;
+
+  private:
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    struct Block
+    {
+      size_t numRows;
+      const double* values;
+    };
+
+    const char* m_Data;
+    size_t m_Size;
+    size_t m_NumRows;
+    std::vector<std::string> m_ColumnNames;
+    std::vector<Block> m_Blocks;
+#ifdef _WIN32
+    std::vector<char> m_Buffer;
+#endif
+  };
+}
@@ -0,0 +1,130 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "patient/conditions/SECondition.h"
+#include "engine/PhysiologyEngineConfiguration.h"
+#include "ContentHash.h"
+#include "StateCache.h"
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Library of stabilized patient states, one for each patient and set of conditions
+/// Initializing an engine with conditions runs the full engine stabilization,
+/// the first engine initialized with a given patient and set of conditions saves its state in the library,
+/// every following engine with the same patient and conditions loads that state instead of stabilizing.
+/// The library is kept on disk, in the states directory, so it persists between runs.
+class ConditionStateLibrary
+{
+public:
+  static ConditionStateLibrary& GetInstance()
+  {
+    static ConditionStateLibrary library("./states/");
+    return library;
+  }
+
+  /// Returns the key of a patient file and set of conditions, stabilized with the given configuration if any,
+  /// it changes if the Pulse version, the patient file, any condition parameter or the configuration changes
+  static std::string GetKey(const std::string& patientFile, const std::vector<const SECondition*>& conditions,
+                            const PhysiologyEngineConfiguration* config = nullptr)
+  {
+    ContentHash hash;
+    hash.Add(std::string(PULSE_PHYSIOLOGY_PULSE_VERSION));
+    hash.Add(patientFile);
+    // Pulse looks for patient files in the patients directory if they are not found as is
+    if (!hash.AddFile(patientFile))
+      hash.AddFile("./patients/" + patientFile);
+    for (const SECondition* condition : conditions)
+    {
+      std::stringstream ss;
+      condition->ToString(ss);
+      hash.Add(ss.str());
+    }
+    if (config != nullptr)
+    {
+      std::string text;
+      config->SerializeToString(text, SerializationMode::ASCII);
+      hash.Add(text);
+    }
+    std::string name = patientFile.substr(patientFile.find_last_of("/\\") + 1);
+    name = name.substr(0, name.find_last_of('.'));
+    return name + "@" + hash.ToString();
+  }
+
+  /// Returns the file the stabilized state of this patient and set of conditions is saved to
+  std::string GetStateFile(const std::string& patientFile, const std::vector<const SECondition*>& conditions,
+                           const PhysiologyEngineConfiguration* config = nullptr) const
+  {
+    return m_Directory + GetKey(patientFile, conditions, config) + ".pba";
+  }
+
+  /// Puts the engine in the stabilized state of the given patient and conditions,
+  /// stabilizing the engine and saving the state in the library if it is not there yet
+  bool InitializeEngine(PhysiologyEngine& pe, const std::string& patientFile, const std::vector<const SECondition*>& conditions,
+                        const PhysiologyEngineConfiguration* config = nullptr)
+  {
+    std::string stateFile = GetStateFile(patientFile, conditions, config);
+    // Serialize engines stabilizing the same state, the second one will load what the first one saved
+    std::shared_ptr<std::mutex> keyMutex = GetMutex(stateFile);
+    std::lock_guard<std::mutex> lock(*keyMutex);
+
+    if (FileExists(stateFile))
+    {
+      if (PatientStateCache::GetInstance().LoadState(pe, stateFile))
+        return true;
+      pe.GetLogger()->Warning("Unable to load stabilized state " + stateFile + ", stabilizing the engine again");
+    }
+
+    if (!pe.InitializeEngine(patientFile, &conditions, config))
+      return false;
+    // Save to a temporary file first, so another process never reads a partially written state
+    std::string tmpFile = stateFile + ".tmp";
+    if (pe.SaveState(tmpFile) == nullptr || std::rename(tmpFile.c_str(), stateFile.c_str()) != 0)
+    {
+      std::remove(tmpFile.c_str());
+      pe.GetLogger()->Warning("Unable to save stabilized state " + stateFile);
+    }
+    else
+      pe.GetLogger()->Info("Saved stabilized state " + stateFile);
+    return true;
+  }
+
+private:
+  ConditionStateLibrary(const std::string& directory) : m_Directory(directory) { }
+  ConditionStateLibrary(const ConditionStateLibrary&) = delete;
+  ConditionStateLibrary& operator=(const ConditionStateLibrary&) = delete;
+
+  static bool FileExists(const std::string& filename)
+  {
+    std::ifstream file(filename);
+    return file.good();
+  }
+
+  std::shared_ptr<std::mutex> GetMutex(const std::string& stateFile)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::shared_ptr<std::mutex>& m = m_KeyMutexes[stateFile];
+    if (m == nullptr)
+      m = std::make_shared<std::mutex>();
+    return m;
+  }
+
+  std::string m_Directory;
+  std::mutex m_Mutex;
+  std::map<std::string, std::shared_ptr<std::mutex>> m_KeyMutexes;
+};
+
+/// Initializes the engine with the given conditions, and configuration if any, through the stabilized state library
+inline bool InitializeEngineFromLibrary(PhysiologyEngine& pe, const std::string& patientFile, const std::vector<const SECondition*>& conditions,
+                                        const PhysiologyEngineConfiguration* config = nullptr)
+{
+  ScopedMetric metric(&ScenarioMetrics::stateLoad_s);
+  ScenarioFiles::AddInput(std::ifstream(patientFile).good() ? patientFile : "./patients/" + patientFile);
+  return ConditionStateLibrary::GetInstance().InitializeEngine(pe, patientFile, conditions, config);
+}
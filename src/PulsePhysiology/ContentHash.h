@@ -0,0 +1,67 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+// Set by CMake from the Pulse package, so that cached states and results are not shared between Pulse versions
+#ifndef PULSE_PHYSIOLOGY_PULSE_VERSION
+#define PULSE_PHYSIOLOGY_PULSE_VERSION "unknown"
+#endif
+
+/// Incremental 64 bit FNV-1a hash, used to build the keys of the on disk state and result caches
+/// This is not a cryptographic hash, it only needs to tell apart inputs we generate ourselves
+class ContentHash
+{
+public:
+  ContentHash() : m_Hash(14695981039346656037ULL) { }
+
+  ContentHash& Add(const void* data, size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+      m_Hash ^= bytes[i];
+      m_Hash *= 1099511628211ULL;
+    }
+    return *this;
+  }
+  ContentHash& Add(const std::string& str)
+  {
+    // Hash the size too, so that ("ab","c") and ("a","bc") are different
+    uint64_t size = str.size();
+    Add(&size, sizeof(size));
+    return Add(str.data(), str.size());
+  }
+  ContentHash& Add(double value)
+  {
+    return Add(&value, sizeof(value));
+  }
+  /// Adds the content of a file, returns false if the file could not be read
+  bool AddFile(const std::string& filename)
+  {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+      return false;
+    std::stringstream content;
+    content << file.rdbuf();
+    Add(content.str());
+    return true;
+  }
+
+  uint64_t GetValue() const { return m_Hash; }
+  /// The hash as a 16 character hex string, suitable for a file name
+  std::string ToString() const
+  {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << m_Hash;
+    return ss.str();
+  }
+
+private:
+  uint64_t m_Hash;
+};
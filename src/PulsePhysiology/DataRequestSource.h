@@ -0,0 +1,91 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "compartment/SECompartmentManager.h"
+#include "compartment/fluid/SEGasCompartment.h"
+#include "compartment/fluid/SELiquidCompartment.h"
+#include "engine/SEEngineTracker.h"
+#include "scenario/SEDataRequest.h"
+#include "scenario/SEDataRequestManager.h"
+#include "TypedSampler.h"
+#include <string>
+#include <vector>
+
+/// Returns the column name of a data request, i.e. Brain-InFlow(mL/min)
+inline std::string GetChannelName(const SEDataRequest& dr)
+{
+  std::string name;
+  if (dr.HasCompartmentName())
+    name = dr.GetCompartmentName() + "-";
+  name += dr.GetPropertyName();
+  if (dr.HasUnit())
+    name += "(" + dr.GetUnit()->GetString() + ")";
+  return name;
+}
+
+/// Samples the data requests registered in the data request manager of the engine, straight from the engine scalars
+/// Physiology and compartment requests are resolved once, when the source is set up, to the scalar they
+/// track and the conversion to their unit, sampling is then a loop over scalar pointers,
+/// with no lookup through the engine tracker. Requests of other categories, or on a substance, are not
+/// resolved and sample NaN. Set the source up again after adding requests or loading a state.
+class DataRequestSource : public ChannelSource
+{
+public:
+  bool Setup(PhysiologyEngine& pe) override
+  {
+    bool found = true;
+    m_Channels.clear();
+    m_Names.clear();
+    for (SEDataRequest* dr : pe.GetEngineTracker()->GetDataRequestManager().GetDataRequests())
+    {
+      m_Names.push_back(::GetChannelName(*dr));
+      m_Channels.push_back(ScalarChannel());
+      const SEScalar* scalar = FindScalar(pe, *dr);
+      if (scalar == nullptr)
+      {
+        pe.GetLogger()->Error("Cannot sample data request " + m_Names.back() + " from the engine scalars");
+        found = false;
+      }
+      else if (!m_Channels.back().Setup(pe, scalar, dr->HasUnit() ? dr->GetUnit() : nullptr))
+      {
+        pe.GetLogger()->Error("Invalid unit for data request " + m_Names.back());
+        found = false;
+      }
+    }
+    return found;
+  }
+
+  size_t GetNumChannels() const override { return m_Channels.size(); }
+  std::string GetChannelName(size_t channel) const override { return m_Names[channel]; }
+
+  void Sample(double, double* values) override
+  {
+    for (size_t i = 0; i < m_Channels.size(); i++)
+      values[i] = m_Channels[i].Sample();
+  }
+
+protected:
+  static const SEScalar* FindScalar(PhysiologyEngine& pe, const SEDataRequest& dr)
+  {
+    if (dr.HasSubstanceName())
+      return nullptr;
+    if (!dr.HasCompartmentName())
+      return FindPhysiologyScalar(pe, dr.GetPropertyName());
+    // Compartment names are unique across gas and liquid compartments,
+    // GetScalar only looks the property up, the engine only hands out const compartments
+    const SECompartmentManager& compartments = pe.GetCompartments();
+    const SEGasCompartment* gas = compartments.GetGasCompartment(dr.GetCompartmentName());
+    if (gas != nullptr)
+      return const_cast<SEGasCompartment*>(gas)->GetScalar(dr.GetPropertyName());
+    const SELiquidCompartment* liquid = compartments.GetLiquidCompartment(dr.GetCompartmentName());
+    if (liquid != nullptr)
+      return const_cast<SELiquidCompartment*>(liquid)->GetScalar(dr.GetPropertyName());
+    return nullptr;
+  }
+
+  std::vector<ScalarChannel> m_Channels;
+  std::vector<std::string> m_Names;
+};
@@ -0,0 +1,147 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "patient/actions/SEAirwayObstruction.h"
+#include "patient/actions/SEAsthmaAttack.h"
+#include "patient/actions/SEChestCompressionForce.h"
+#include "properties/SEScalar0To1.h"
+#include "properties/SEScalarForce.h"
+#include "PhaseProfiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+/// Wait-free single producer, single consumer ring buffer of Capacity elements, Capacity must be a power of 2
+/// The producer only writes the tail and the consumer only writes the head, each on its own cache line,
+/// so pushing and popping never take a lock, never allocate and never wait on the other thread.
+template<typename T, size_t Capacity>
+class SPSCQueue
+{
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of 2");
+public:
+  SPSCQueue() : m_Head(0), m_Tail(0) { }
+
+  /// Producer side, returns false if the queue is full
+  bool TryPush(const T& value)
+  {
+    size_t tail = m_Tail.load(std::memory_order_relaxed);
+    if (tail - m_Head.load(std::memory_order_acquire) == Capacity)
+      return false;
+    m_Buffer[tail & (Capacity - 1)] = value;
+    m_Tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer side, returns false if the queue is empty
+  bool TryPop(T& value)
+  {
+    size_t head = m_Head.load(std::memory_order_relaxed);
+    if (head == m_Tail.load(std::memory_order_acquire))
+      return false;
+    value = m_Buffer[head & (Capacity - 1)];
+    m_Head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  alignas(64) std::atomic<size_t> m_Head;
+  alignas(64) std::atomic<size_t> m_Tail;
+  alignas(64) T m_Buffer[Capacity];
+};
+
+/// The device inputs that can be sent to an engine, each one sets the force or severity of an action
+enum class DeviceInput { ChestCompressionForce = 0, AirwayObstructionSeverity, AsthmaAttackSeverity, Count };
+
+/// Device inputs sent to an engine from another thread, i.e. the force sensor of a CPR manikin sampled at 1kHz
+/// Inputs are plain values, copied in a preallocated queue, the engine thread drains the queue before each time step
+/// into actions allocated once, so neither side locks or allocates.
+/// A device usually samples faster than the engine steps, only the latest value of each input is applied,
+/// the older ones are counted as superseded. The age of every applied input, from the time it was pushed
+/// to the time its action was processed, is recorded in a histogram.
+class DeviceInputQueue
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Input
+  {
+    DeviceInput type;
+    double value;       // Force in N, or severity between 0 and 1
+    Clock::time_point time;
+  };
+
+  DeviceInputQueue() : m_Dropped(0), m_Superseded(0) { }
+
+  /// Producer side, returns false and counts the input as dropped if the engine is too far behind
+  bool Push(DeviceInput type, double value)
+  {
+    if (m_Queue.TryPush({ type, value, Clock::now() }))
+      return true;
+    m_Dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  /// Engine side, processes the latest value of each input pushed since the last call, with the given processor
+  /// i.e. an engine or a HowToTracker, returns the number of actions processed
+  template<typename Processor>
+  size_t Drain(Processor& processor)
+  {
+    Input latest[static_cast<int>(DeviceInput::Count)];
+    bool pending[static_cast<int>(DeviceInput::Count)] = {};
+    Input input;
+    while (m_Queue.TryPop(input))
+    {
+      int i = static_cast<int>(input.type);
+      if (pending[i])
+        m_Superseded++;
+      latest[i] = input;
+      pending[i] = true;
+    }
+
+    size_t processed = 0;
+    for (int i = 0; i < static_cast<int>(DeviceInput::Count); i++)
+    {
+      if (!pending[i])
+        continue;
+      switch (static_cast<DeviceInput>(i))
+      {
+      case DeviceInput::ChestCompressionForce:
+        m_ChestCompression.GetForce().SetValue(latest[i].value, ForceUnit::N);
+        processor.ProcessAction(m_ChestCompression);
+        break;
+      case DeviceInput::AirwayObstructionSeverity:
+        m_AirwayObstruction.GetSeverity().SetValue(latest[i].value);
+        processor.ProcessAction(m_AirwayObstruction);
+        break;
+      case DeviceInput::AsthmaAttackSeverity:
+        m_AsthmaAttack.GetSeverity().SetValue(latest[i].value);
+        processor.ProcessAction(m_AsthmaAttack);
+        break;
+      default:
+        break;
+      }
+      m_InputAge.Record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - latest[i].time).count()));
+      processed++;
+    }
+    return processed;
+  }
+
+  /// Time from pushing an input to processing its action, only read from the engine thread
+  const LatencyHistogram& GetInputAge() const { return m_InputAge; }
+  /// Inputs replaced by a newer value of the same input before the engine got to them
+  size_t GetNumSuperseded() const { return m_Superseded; }
+  /// Inputs lost because the queue was full
+  size_t GetNumDropped() const { return m_Dropped.load(std::memory_order_relaxed); }
+
+private:
+  SPSCQueue<Input, 4096> m_Queue;
+  std::atomic<size_t> m_Dropped;
+  size_t m_Superseded;
+  LatencyHistogram m_InputAge;
+  SEChestCompressionForce m_ChestCompression;
+  SEAirwayObstruction m_AirwayObstruction;
+  SEAsthmaAttack m_AsthmaAttack;
+};
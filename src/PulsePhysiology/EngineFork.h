@@ -0,0 +1,117 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "EngineUse.h"
+#include <google/protobuf/message.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// In memory image of an engine at a branch point of a simulation
+/// Parameter sweeps usually share a long prefix, i.e. warming up a patient and putting it in cardiac arrest,
+/// and only differ in what is done afterwards. The prefix is simulated once, snapshot, and every variant
+/// is forked from the snapshot, without going through the file system.
+/// A snapshot is never modified once taken, so engines on different threads can be forked from it at once.
+class EngineSnapshot
+{
+public:
+  /// Snapshot of the current state of the engine
+  EngineSnapshot(PhysiologyEngine& pe) : m_State(pe.SaveState()) { }
+
+  bool IsValid() const { return m_State != nullptr; }
+
+  /// Brings the engine back to the snapshot
+  bool Restore(PhysiologyEngine& pe) const
+  {
+    ScopedMetric metric(&ScenarioMetrics::stateLoad_s);
+    return IsValid() && pe.LoadState(*m_State);
+  }
+
+  /// Creates a new engine, logging to the given file, in the state of the snapshot
+  /// The data requests of the forked engine are cleared, each branch sets up its own results.
+  /// Returns nullptr if the state could not be loaded.
+  PooledEngine Fork(const std::string& logFile) const
+  {
+    PooledEngine pe = CreateScenarioEngine(logFile);
+    if (!Restore(*pe))
+    {
+      pe->GetLogger()->Error("Could not fork the engine, check the error");
+      return nullptr;
+    }
+    pe->GetEngineTracker()->GetDataRequestManager().Clear();
+    return pe;
+  }
+
+private:
+  std::shared_ptr<const google::protobuf::Message> m_State;
+};
+
+/// Forks n engines from the current state of the given engine, engine i logs to <logPrefix>_<i>.log
+/// Engines that could not be forked are left nullptr.
+inline std::vector<PooledEngine> ForkEngine(PhysiologyEngine& pe, size_t n, const std::string& logPrefix)
+{
+  EngineSnapshot snapshot(pe);
+  std::vector<PooledEngine> engines;
+  for (size_t i = 0; i < n; i++)
+    engines.push_back(snapshot.Fork(logPrefix + "_" + std::to_string(i) + ".log"));
+  return engines;
+}
+
+/// The instrumentation installed on the thread of a scenario, handed to the threads its forked engines run on
+/// Capture it on the scenario thread, and install it on a worker thread for the duration of a branch with a Scope.
+/// Branches record their files in the ScenarioFiles of the scenario, which is thread safe,
+/// and their profile and metrics on their own, added to the ones of the scenario when the branch ends.
+class ScenarioContext
+{
+public:
+  ScenarioContext()
+    : m_Files(ScenarioFiles::Current()), m_Profiler(PhaseProfiler::Current()), m_Metrics(ScenarioMetrics::Current()) { }
+
+  /// Installs the context on the current thread, and puts back what was installed before when it goes out of scope
+  class Scope
+  {
+  public:
+    Scope(ScenarioContext& context)
+      : m_Context(context), m_Files(ScenarioFiles::Current()), m_Profiler(PhaseProfiler::Current()),
+        m_Metrics(ScenarioMetrics::Current())
+    {
+      ScenarioFiles::Current() = context.m_Files;
+      if (context.m_Profiler != nullptr)
+        m_BranchProfiler.reset(new PhaseProfiler());
+      PhaseProfiler::Current() = m_BranchProfiler.get();
+      if (context.m_Metrics != nullptr)
+        m_BranchMetrics.reset(new ScenarioMetrics());
+      ScenarioMetrics::Current() = m_BranchMetrics.get();
+    }
+    ~Scope()
+    {
+      ScenarioFiles::Current() = m_Files;
+      PhaseProfiler::Current() = m_Profiler;
+      ScenarioMetrics::Current() = m_Metrics;
+      std::lock_guard<std::mutex> lock(m_Context.m_Mutex);
+      if (m_BranchProfiler != nullptr)
+        m_Context.m_Profiler->Merge(*m_BranchProfiler);
+      if (m_BranchMetrics != nullptr)
+        m_Context.m_Metrics->Merge(*m_BranchMetrics);
+    }
+
+  private:
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ScenarioContext& m_Context;
+    ScenarioFiles* m_Files;       // Installed before the scope
+    PhaseProfiler* m_Profiler;
+    ScenarioMetrics* m_Metrics;
+    std::unique_ptr<PhaseProfiler> m_BranchProfiler;
+    std::unique_ptr<ScenarioMetrics> m_BranchMetrics;
+  };
+
+private:
+  ScenarioFiles* m_Files;
+  PhaseProfiler* m_Profiler;
+  ScenarioMetrics* m_Metrics;
+  std::mutex m_Mutex;  // Branches end on different threads
+};
@@ -0,0 +1,129 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "engine/SEEngineTracker.h"
+#include "patient/SEPatient.h"
+#include "scenario/SEDataRequestManager.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Process wide pool of engines, so short runs and sweeps do not pay for constructing and destroying an engine each time
+/// Constructing an engine loads its configuration and substance tables, and destroying it frees them.
+/// A pooled engine is given back to the pool when released, and handed out again by the next acquire,
+/// with its data requests cleared and its log redirected. Its state is the one of its last run
+/// until it is reset to a patient state: load one with LoadCachedState, as every scenario does first,
+/// and the engine is reset in place from the in memory state, reusing its allocations.
+/// This class is thread safe, engines can be acquired and released on any thread.
+class EnginePool
+{
+public:
+  /// Gives pooled engines back to the pool, and deletes the others
+  struct Deleter
+  {
+    Deleter() : pooled(false) { }
+    explicit Deleter(bool p) : pooled(p) { }
+    // Engines that were not acquired from the pool, i.e. created with CreatePulseEngine, are deleted
+    Deleter(std::default_delete<PhysiologyEngine>) : pooled(false) { }
+    void operator()(PhysiologyEngine* pe) const
+    {
+      if (pooled)
+        EnginePool::GetInstance().Release(pe);
+      else
+        delete pe;
+    }
+    bool pooled;
+  };
+  typedef std::unique_ptr<PhysiologyEngine, Deleter> Engine;
+
+  static EnginePool& GetInstance()
+  {
+    static EnginePool pool;
+    return pool;
+  }
+
+  /// Whether the scenario engines come from the pool
+  static bool& GetDefaultEnabled()
+  {
+    static bool enabled = false;
+    return enabled;
+  }
+
+  /// Returns an idle engine logging to the given file, or a new engine if none is idle
+  Engine Acquire(const std::string& logFile)
+  {
+    std::unique_ptr<PhysiologyEngine> pe;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if (!m_Idle.empty())
+      {
+        pe = std::move(m_Idle.back());
+        m_Idle.pop_back();
+        m_NumReused++;
+      }
+    }
+    if (pe == nullptr)
+      return Engine(CreatePulseEngine(logFile).release(), Deleter(true));
+
+    // The results and requests of the last run are not carried over to the next one
+    pe->GetLogger()->ResetLogFile(logFile);
+    pe->GetLogger()->LogToConsole(true);
+    SEDataRequestManager& requests = pe->GetEngineTracker()->GetDataRequestManager();
+    requests.Clear();
+    requests.SetResultsFilename("");
+    return Engine(pe.release(), Deleter(true));
+  }
+
+  /// Keeps the engine for the next acquire, or deletes it if enough engines are idle already
+  void Release(PhysiologyEngine* engine)
+  {
+    std::unique_ptr<PhysiologyEngine> pe(engine);
+    // The handler of the last run does not outlive it
+    pe->GetPatient().ForwardEvents(nullptr);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Idle.size() < m_MaxIdle)
+      m_Idle.push_back(std::move(pe));
+  }
+
+  /// Most engines kept idle, one per core by default, the others are deleted when released
+  void SetMaxIdle(size_t maxIdle)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MaxIdle = maxIdle;
+    if (m_Idle.size() > m_MaxIdle)
+      m_Idle.resize(m_MaxIdle);
+  }
+
+  /// Number of engines handed out again rather than constructed
+  size_t GetNumReused() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_NumReused;
+  }
+
+  /// Deletes the idle engines
+  void Clear()
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Idle.clear();
+  }
+
+private:
+  EnginePool() : m_MaxIdle(std::max(1u, std::thread::hardware_concurrency())), m_NumReused(0) { }
+  EnginePool(const EnginePool&) = delete;
+  EnginePool& operator=(const EnginePool&) = delete;
+
+  mutable std::mutex m_Mutex;
+  std::vector<std::unique_ptr<PhysiologyEngine>> m_Idle;
+  size_t m_MaxIdle;
+  size_t m_NumReused;
+};
+
+/// An engine of a scenario, given back to the pool when it comes from it
+typedef EnginePool::Engine PooledEngine;
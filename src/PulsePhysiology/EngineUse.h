@@ -1,5 +1,6 @@
 /* Distributed under the Apache License, Version 2.0.
    See accompanying NOTICE file for details.*/
+#pragma once
 
 // Note that this project is set with the following Additional Include Paths: ../include;../include/cdm;../include/cdm/bind
 // This will build an executable that is intended to execute a how-to method
@@ -26,10 +27,45 @@
 #include "properties/SEScalarVolumePerTime.h"
 #include "engine/SEEngineTracker.h"
 #include "compartment/SECompartmentManager.h"
+#include "StateCache.h"
+#include "ConditionStateLibrary.h"
+#include "ResultsSampler.h"
+#include "TypedSampler.h"
+#include "VitalsSnapshot.h"
+#include "ScenarioMetrics.h"
+#include "PhaseProfiler.h"
+#include "RealTimePacer.h"
+#include "CheckpointCache.h"
+#include "EnginePool.h"
+#include "DeviceInputQueue.h"
+#include "ActionTimeline.h"
+#include "BinaryLog.h"
+#include "StopCondition.h"
+#include "EventRecorder.h"
 
 // The following how-to functions are defined in their own file
 void HowToEngineUse();
 
+/// Whether the engines created for the how-to scenarios log to the console, benchmarks turn it off
+inline bool& ScenarioLogToConsole()
+{
+  static bool logToConsole = true;
+  return logToConsole;
+}
+
+/// Creates the engine of a how-to scenario, logging to the given file
+/// When pooling, an idle engine is reused instead, the scenario resets it when it loads its state
+inline PooledEngine CreateScenarioEngine(const std::string& logFile)
+{
+  ScopedMetric metric(&ScenarioMetrics::engineCreation_s);
+  ScenarioFiles::AddOutput(logFile);
+  PooledEngine pe = EnginePool::GetDefaultEnabled() ? EnginePool::GetInstance().Acquire(logFile) : CreatePulseEngine(logFile);
+  BinaryLog::RegisterSource(pe->GetLogger(), logFile);
+  if (!ScenarioLogToConsole())
+    pe->GetLogger()->LogToConsole(false);
+  return pe;
+}
+
 
 class SEDataRequest;
 
@@ -40,25 +76,302 @@ class HowToTracker
 {
 private:
   double m_dT_s;  // Cached Engine Time Step
+  size_t m_Step;  // Number of time steps computed so far
   PhysiologyEngine& m_Engine;
+  ResultsSampler m_Results;
+  std::unique_ptr<RealTimePacer> m_Pacer; // Only used when running in real time
+  std::unique_ptr<ScenarioCheckpoints> m_Checkpoints; // Only used when checkpointing
+  DeviceInputQueue* m_Inputs; // Inputs from device threads, drained before each time step
+  bool m_EarlyStop;           // Whether the stop conditions are checked
+  std::vector<StopCondition*> m_StopConditions;
+  std::vector<VitalsReader*> m_Readers; // Reset when the engine is loaded from a checkpoint
+  const StopCondition* m_Stopped; // The condition that stopped the run, nullptr while running
+  std::unique_ptr<EventRecorder> m_Events; // Only used when recording events
+  size_t m_SegmentFirstEvent; // First event of the advance, saved with its checkpoint
 public:
-  HowToTracker(PhysiologyEngine& engine) : m_Engine(engine)
+  HowToTracker(PhysiologyEngine& engine) : m_Engine(engine), m_Results(engine)
   {
     m_dT_s = m_Engine.GetTimeStep(TimeUnit::s);
+    m_Step = 0;
+    m_Inputs = nullptr;
+    m_EarlyStop = GetDefaultEarlyStop();
+    m_Stopped = nullptr;
+    m_SegmentFirstEvent = 0;
+    if (GetDefaultRealTime())
+      SetRealTime(true);
+    if (ScenarioCheckpoints::GetDefaultEnabled())
+      m_Checkpoints.reset(new ScenarioCheckpoints(m_Engine));
+    if (GetDefaultRecordEvents())
+    {
+      m_Events.reset(new EventRecorder(m_Engine));
+      m_Engine.GetPatient().ForwardEvents(m_Events.get());
+    }
+  }
+  ~HowToTracker()
+  {
+    if (m_Events != nullptr)
+    {
+      m_Engine.GetPatient().ForwardEvents(nullptr);
+      // Written next to the results, the run has no events file if it has no results file
+      if (!m_Results.GetFilename().empty())
+      {
+        std::string file = EventRecorder::GetFilename(m_Results.GetFilename());
+        ScenarioFiles::AddOutput(file);
+        if (!m_Events->Write(file))
+          m_Engine.GetLogger()->Error("Unable to write events file " + file);
+      }
+    }
+    if (m_Pacer != nullptr)
+    {
+      std::stringstream ss;
+      m_Pacer->GetStats().Write(ss);
+      m_Engine.GetLogger()->Info(ss);
+    }
+  }
+
+  // Whether new trackers run in real time
+  static bool& GetDefaultRealTime()
+  {
+    static bool realTime = false;
+    return realTime;
+  }
+
+  // Whether new trackers record the events of their engine to an events file, next to the results file
+  static bool& GetDefaultRecordEvents()
+  {
+    static bool recordEvents = false;
+    return recordEvents;
+  }
+
+  // Forwards the events of the engine to the given handler, use this rather than the engine
+  // so the events are still recorded, nullptr to stop
+  void ForwardEvents(SEEventHandler* handler)
+  {
+    if (m_Events != nullptr)
+      m_Events->SetForward(handler);
+    else
+      m_Engine.GetPatient().ForwardEvents(handler);
+  }
+
+  // Whether new trackers stop their runs early, when one of their stop conditions is met
+  static bool& GetDefaultEarlyStop()
+  {
+    static bool earlyStop = false;
+    return earlyStop;
+  }
+
+  // Once a stop condition is met, the current advance ends and the following ones return right away,
+  // so the rest of the scenario only logs the state the run stopped in.
+  // Conditions are checked after each time step computed, not across time steps loaded from a checkpoint
+  void SetEarlyStop(bool earlyStop) { m_EarlyStop = earlyStop; }
+  void AddStopCondition(StopCondition& condition) { m_StopConditions.push_back(&condition); }
+  bool IsStopped() const { return m_Stopped != nullptr; }
+
+  // In real time, each time step is computed when it is due on the wall clock,
+  // after a stall up to maxBurst late steps are computed back to back to catch up
+  void SetRealTime(bool realTime, size_t maxBurst = 10)
+  {
+    m_Pacer.reset(realTime ? new RealTimePacer(m_dT_s, maxBurst) : nullptr);
+  }
+  const RealTimeStats* GetRealTimeStats() const { return m_Pacer == nullptr ? nullptr : &m_Pacer->GetStats(); }
+
+  // Decimate the output, by default every data request is written at every time step
+  void SetSamplePeriod(double period_s) { m_Results.SetSamplePeriod(period_s); }
+  void SetSamplePeriod(const SEDataRequest& dr, double period_s) { m_Results.SetSamplePeriod(dr, period_s); }
+
+  // Readers of the scenario on the engine of this tracker, they are reset when the engine is loaded from a checkpoint
+  void AddVitalsReader(VitalsReader& reader) { m_Readers.push_back(&reader); }
+
+  // Sample the channels of a schema, declared with PULSE_CHANNEL_SCHEMA, along with the data requests
+  // Returns the values of the last sample, they are updated at the sample period of the data requests
+  template<typename Schema>
+  const Schema& TrackSchema()
+  {
+    TypedSampler<Schema>* sampler = new TypedSampler<Schema>();
+    m_Results.AddChannels(std::unique_ptr<ChannelSource>(sampler));
+    return sampler->GetValues();
+  }
+
+  // Process the inputs pushed by device threads to the given queue before each time step, nullptr to stop
+  void SetInputQueue(DeviceInputQueue* inputs) { m_Inputs = inputs; }
+
+  // Tell the profiler which phase of the scenario we are in, if the scenario is profiled
+  void SetPhase(ScenarioPhase phase)
+  {
+    if (PhaseProfiler::Current() != nullptr)
+      PhaseProfiler::Current()->SetPhase(phase);
+  }
+
+  bool ProcessAction(const SEAction& action)
+  {
+    if (m_Checkpoints != nullptr)
+      m_Checkpoints->AddAction(action);
+    return ApplyAction(action);
+  }
+
+  double GetTimeStep_s() const { return m_dT_s; }
+
+  // This class will operate on seconds, the time is rounded to the nearest time step
+  // Returns false if the run was stopped early
+  bool AdvanceModelTime(double time_s)
+  {
+    if (IsStopped())
+      return false;
+    size_t count = static_cast<size_t>(std::max(0L, std::lround(time_s / m_dT_s)));
+    if (m_Checkpoints != nullptr && Resume(count))
+      return true;
+    for (size_t i = 0; i < count; i++)
+    {
+      if (!Step())
+        return false;
+    }
+    if (m_Checkpoints != nullptr)
+      Computed(count);
+    return true;
+  }
+
+  // Runs the timeline from the current time, each action is processed right before its time step
+  // Returns false if the run was stopped early, the actions after that time step are not processed
+  bool Run(const ActionTimeline& timeline)
+  {
+    if (IsStopped())
+      return false;
+    const std::vector<ActionTimeline::Entry>& entries = timeline.GetEntries();
+    size_t count = timeline.GetNumSteps();
+    if (m_Checkpoints != nullptr)
+    {
+      for (const ActionTimeline::Entry& entry : entries)
+        m_Checkpoints->AddActionAtStep(entry.step, *entry.action);
+      if (Resume(count))
+        return true;
+    }
+    size_t next = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+      for (; next < entries.size() && entries[next].step <= i; next++)
+        ApplyAction(*entries[next].action);
+      if (!Step())
+        return false;
+    }
+    for (; next < entries.size(); next++)
+      ApplyAction(*entries[next].action);
+    if (m_Checkpoints != nullptr)
+      Computed(count);
+    return true;
+  }
+
+private:
+  bool ApplyAction(const SEAction& action)
+  {
+    ScopedCallTimer timer(EngineCall::ProcessAction);
+    return m_Engine.ProcessAction(action);
   }
-  ~HowToTracker() { }
 
-  // This class will operate on seconds
-  void AdvanceModelTime(double time_s)
+  // Loads the checkpoint at the end of the next count time steps, if there is one
+  // The results must be the same as those of a run that computes every time step, so the rows and events of the
+  // time steps loaded are replayed from the segment files saved with the checkpoint, it is not loaded without them
+  bool Resume(size_t count)
   {
-    // This samples the engine at each time step
-    int count = static_cast<int>(time_s / m_dT_s);
-    for (int i = 0; i <= count; i++)
+    m_Checkpoints->AddAdvance(count);
+    m_Results.StartSegment();
+    m_SegmentFirstEvent = m_Events != nullptr ? m_Events->GetNumEvents() : 0;
+    if (!m_Checkpoints->IsSaved())
+      return false;
+
+    m_Results.Prepare();
+    std::vector<double> rows;
+    EventStore::Events events;
+    bool hasResults = !m_Results.GetFilename().empty();
+    if (hasResults && !m_Results.ReadSegment(m_Checkpoints->GetSegmentFile(m_Results.GetLayout() + ".rows"), rows))
     {
+      m_Engine.GetLogger()->Info("The checkpoint has no results for these data requests, computing the time steps again");
+      return false;
+    }
+    if (hasResults && m_Events != nullptr && !EventStore::Read(m_Checkpoints->GetSegmentFile("events"), events))
+    {
+      m_Engine.GetLogger()->Info("The checkpoint has no events, computing the time steps again");
+      return false;
+    }
+    if (!m_Checkpoints->Resume())
+      return false;
+    m_Results.Replay(rows);
+    if (hasResults && m_Events != nullptr)
+      m_Events->Replay(events);
+
+    // The engine was loaded at the end of these time steps, they are not computed again
+    m_Step += count;
+    // Loading replaced the engine scalars, everything reading them connects to the new ones
+    m_Results.Reset();
+    for (StopCondition* condition : m_StopConditions)
+      condition->Reset(m_Engine);
+    for (VitalsReader* reader : m_Readers)
+      reader->Reset();
+    if (m_Pacer != nullptr)
+      m_Pacer->Reset();
+    return true;
+  }
+
+  // Call once the time steps of an advance that was not resumed are computed, saves its rows and events
+  // along its checkpoint, if it has one now, for the runs resuming from it
+  void Computed(size_t count)
+  {
+    m_Checkpoints->Computed(count * m_dT_s);
+    if (m_Results.GetFilename().empty() || !m_Checkpoints->IsSaved())
+      return;
+    std::string file = m_Checkpoints->GetSegmentFile(m_Results.GetLayout() + ".rows");
+    if (!m_Results.SaveSegment(file))
+      m_Engine.GetLogger()->Warning("Unable to save the results of checkpoint " + file);
+    file = m_Checkpoints->GetSegmentFile("events");
+    if (m_Events != nullptr && !m_Events->SaveSegment(file, m_SegmentFirstEvent))
+      m_Engine.GetLogger()->Warning("Unable to save the events of checkpoint " + file);
+  }
+
+  // Computes one time step and samples its results, returns false if a stop condition is met
+  // The engine is then part way through an advance, so no checkpoint is saved for it
+  bool Step()
+  {
+    if (m_Pacer != nullptr)
+      m_Pacer->WaitForNextStep();
+    if (m_Inputs != nullptr)
+      m_Inputs->Drain(*this);
+
+    // Only time steps when a benchmark is collecting metrics
+    ScenarioMetrics* metrics = ScenarioMetrics::Current();
+    ScenarioMetrics::Clock::time_point start;
+    if (metrics != nullptr)
+      start = ScenarioMetrics::Clock::now();
+
+    {
+      ScopedCallTimer timer(EngineCall::AdvanceModelTime);
       m_Engine.AdvanceModelTime();  // Compute 1 time step
+    }
+    {
+      ScopedCallTimer timer(EngineCall::TrackData);
+      // Pull data from the engine and append it to the file, if any data request is due
+      m_Results.Sample(m_Step++, m_Engine.GetSimulationTime(TimeUnit::s));
+    }
 
-                                    // Pull Track will pull data from the engine and append it to the file
-      m_Engine.GetEngineTracker()->TrackData(m_Engine.GetSimulationTime(TimeUnit::s));
+    if (metrics != nullptr)
+    {
+      double latency_s = ScenarioMetrics::Seconds(start, ScenarioMetrics::Clock::now());
+      metrics->stepLatencies_s.push_back(latency_s);
+      metrics->stepping_s += latency_s;
+      metrics->simTime_s += m_dT_s;
+    }
+
+    if (m_EarlyStop)
+    {
+      double time_s = m_Engine.GetSimulationTime(TimeUnit::s);
+      for (StopCondition* condition : m_StopConditions)
+      {
+        if (condition->IsMet(time_s))
+        {
+          m_Stopped = condition;
+          SCENARIO_LOG_INFO(m_Engine.GetLogger(), "Stopping the run early, {}", condition->GetReason());
+          return false;
+        }
+      }
     }
+    return true;
   }
 };
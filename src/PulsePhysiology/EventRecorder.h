@@ -0,0 +1,122 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "engine/SEEventHandler.h"
+#include "patient/SEPatient.h"
+#include "properties/SEScalarTime.h"
+#include "EventStore.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// Records the events of an engine with their simulation time and whether they became active or inactive
+/// Events are received on the engine thread, during the time step that raised them, so recording one
+/// is an append to the columns, with no lock, and no allocation until the preallocated capacity is used.
+/// The columns are written to an EventStore file, next to the results file, when the run ends.
+/// The engine forwards its events to a single handler, the recorder forwards them on to the handler of the scenario.
+/// The events of a segment of the run can be saved, so a run resumed from a checkpoint replays them.
+class EventRecorder : public SEEventHandler
+{
+public:
+  EventRecorder(PhysiologyEngine& engine, size_t capacity = 1024) : m_Engine(engine), m_Forward(nullptr)
+  {
+    m_Events.time_s.reserve(capacity);
+    m_Events.type.reserve(capacity);
+    m_Events.active.reserve(capacity);
+  }
+
+  /// The handler that also receives every event, nullptr for none
+  void SetForward(SEEventHandler* forward) { m_Forward = forward; }
+
+  void HandlePatientEvent(cdm::ePatient_Event type, bool active, const SEScalarTime* time) override
+  {
+    Append(m_PatientTypes, static_cast<int>(type), "Patient.", cdm::ePatient_Event_Name(type), active, time);
+    if (m_Forward != nullptr)
+      m_Forward->HandlePatientEvent(type, active, time);
+  }
+
+  void HandleAnesthesiaMachineEvent(cdm::eAnesthesiaMachine_Event type, bool active, const SEScalarTime* time) override
+  {
+    Append(m_AnesthesiaMachineTypes, static_cast<int>(type), "AnesthesiaMachine.", cdm::eAnesthesiaMachine_Event_Name(type), active, time);
+    if (m_Forward != nullptr)
+      m_Forward->HandleAnesthesiaMachineEvent(type, active, time);
+  }
+
+  const EventStore::Events& GetEvents() const { return m_Events; }
+  size_t GetNumEvents() const { return m_Events.time_s.size(); }
+
+  /// Saves the events recorded from the given one on, i.e. the events of the advance that ends at a checkpoint
+  bool SaveSegment(const std::string& filename, size_t first) const
+  {
+    EventStore::Events segment;
+    segment.names = m_Events.names;
+    segment.time_s.assign(m_Events.time_s.begin() + first, m_Events.time_s.end());
+    segment.type.assign(m_Events.type.begin() + first, m_Events.type.end());
+    segment.active.assign(m_Events.active.begin() + first, m_Events.active.end());
+    // Save to a temporary file first, so another process never reads a partially written segment
+    std::string tmpFile = filename + ".tmp";
+    if (!EventStore::Write(tmpFile, segment) || std::rename(tmpFile.c_str(), filename.c_str()) != 0)
+    {
+      std::remove(tmpFile.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  /// Records the events of a segment read back from its file, as if they were received
+  /// They are not forwarded, the handler of the scenario was not called for the time steps resumed from a checkpoint.
+  void Replay(const EventStore::Events& segment)
+  {
+    for (size_t r = 0; r < segment.time_s.size(); r++)
+    {
+      m_Events.time_s.push_back(segment.time_s[r]);
+      m_Events.type.push_back(GetType(segment.names[segment.type[r]]));
+      m_Events.active.push_back(segment.active[r]);
+    }
+  }
+
+  /// The events file of a results file, i.e. CPR.events for CPR.csv
+  static std::string GetFilename(const std::string& resultsFilename)
+  {
+    return resultsFilename.substr(0, resultsFilename.find_last_of('.')) + ".events";
+  }
+
+  bool Write(const std::string& filename) const { return EventStore::Write(filename, m_Events); }
+
+private:
+  // Event enums are small, so the index of each type is a lookup in a vector
+  void Append(std::vector<int>& types, int value, const char* prefix, const std::string& name, bool active, const SEScalarTime* time)
+  {
+    if (value < 0)
+      return;
+    if (static_cast<size_t>(value) >= types.size())
+      types.resize(value + 1, -1);
+    if (types[value] < 0)
+      types[value] = static_cast<int>(GetType(prefix + name));
+    m_Events.time_s.push_back(time != nullptr ? time->GetValue(TimeUnit::s) : m_Engine.GetSimulationTime(TimeUnit::s));
+    m_Events.type.push_back(static_cast<uint32_t>(types[value]));
+    m_Events.active.push_back(active ? 1 : 0);
+  }
+
+  // The index of a name, added if it is new, names may be recorded by replays before they are received
+  uint32_t GetType(const std::string& name)
+  {
+    for (size_t t = 0; t < m_Events.names.size(); t++)
+    {
+      if (m_Events.names[t] == name)
+        return static_cast<uint32_t>(t);
+    }
+    m_Events.names.push_back(name);
+    return static_cast<uint32_t>(m_Events.names.size() - 1);
+  }
+
+  PhysiologyEngine& m_Engine;
+  SEEventHandler* m_Forward;
+  EventStore::Events m_Events;
+  std::vector<int> m_PatientTypes;            // Index of the name of each patient event, -1 until it is received
+  std::vector<int> m_AnesthesiaMachineTypes;
+};
@@ -0,0 +1,143 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+
+#include "EventStore.h"
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace EventStore
+{
+  // Number of bytes left to read, sizes read from the file are checked against it before allocating
+  static uint64_t GetRemaining(std::istream& in)
+  {
+    std::streampos position = in.tellg();
+    if (position < 0)
+      return 0;
+    in.seekg(0, std::ios::end);
+    std::streampos end = in.tellg();
+    in.seekg(position);
+    return end > position ? static_cast<uint64_t>(end - position) : 0;
+  }
+
+  static bool ReadHeader(std::istream& in, std::vector<IndexEntry>& index, uint64_t& numRecords)
+  {
+    char magic[sizeof(Magic)];
+    uint32_t version, numTypes;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, Magic, sizeof(Magic)) != 0)
+      return false;
+    if (!in.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != Version)
+      return false;
+    if (!in.read(reinterpret_cast<char*>(&numTypes), sizeof(numTypes)))
+      return false;
+    index.clear();
+    for (uint32_t t = 0; t < numTypes; t++)
+    {
+      IndexEntry e;
+      uint32_t length;
+      if (!in.read(reinterpret_cast<char*>(&length), sizeof(length)) || length > GetRemaining(in))
+        return false;
+      e.name.resize(length);
+      if (length > 0 && !in.read(&e.name[0], length))
+        return false;
+      if (!in.read(reinterpret_cast<char*>(&e.firstActive_s), sizeof(e.firstActive_s)) ||
+          !in.read(reinterpret_cast<char*>(&e.count), sizeof(e.count)))
+        return false;
+      index.push_back(e);
+    }
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&numRecords), sizeof(numRecords)));
+  }
+
+  bool Write(const std::string& filename, const Events& events)
+  {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out)
+      return false;
+    size_t numRecords = events.time_s.size();
+    std::vector<IndexEntry> index(events.names.size());
+    for (size_t t = 0; t < index.size(); t++)
+    {
+      index[t].name = events.names[t];
+      index[t].firstActive_s = std::numeric_limits<double>::quiet_NaN();
+      index[t].count = 0;
+    }
+    for (size_t r = 0; r < numRecords; r++)
+    {
+      IndexEntry& e = index[events.type[r]];
+      e.count++;
+      if (events.active[r] && e.firstActive_s != e.firstActive_s)
+        e.firstActive_s = events.time_s[r];
+    }
+
+    out.write(Magic, sizeof(Magic));
+    uint32_t value = Version;
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    value = static_cast<uint32_t>(index.size());
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    for (const IndexEntry& e : index)
+    {
+      value = static_cast<uint32_t>(e.name.size());
+      out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+      out.write(e.name.data(), e.name.size());
+      out.write(reinterpret_cast<const char*>(&e.firstActive_s), sizeof(e.firstActive_s));
+      out.write(reinterpret_cast<const char*>(&e.count), sizeof(e.count));
+    }
+    uint64_t n = numRecords;
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    out.write(reinterpret_cast<const char*>(events.time_s.data()), numRecords * sizeof(double));
+    out.write(reinterpret_cast<const char*>(events.type.data()), numRecords * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(events.active.data()), numRecords * sizeof(uint8_t));
+    return static_cast<bool>(out);
+  }
+
+  bool ReadIndex(const std::string& filename, std::vector<IndexEntry>& index)
+  {
+    std::ifstream in(filename, std::ios::binary);
+    uint64_t numRecords;
+    return in && ReadHeader(in, index, numRecords);
+  }
+
+  bool Read(const std::string& filename, Events& events)
+  {
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<IndexEntry> index;
+    uint64_t numRecords;
+    if (!in || !ReadHeader(in, index, numRecords))
+      return false;
+    // Each record takes a time, a type and an active flag
+    const uint64_t recordSize = sizeof(double) + sizeof(uint32_t) + sizeof(uint8_t);
+    if (numRecords > GetRemaining(in) / recordSize)
+      return false;
+    events.names.clear();
+    for (const IndexEntry& e : index)
+      events.names.push_back(e.name);
+    size_t n = static_cast<size_t>(numRecords);
+    events.time_s.resize(n);
+    events.type.resize(n);
+    events.active.resize(n);
+    if (!in.read(reinterpret_cast<char*>(events.time_s.data()), n * sizeof(double)) ||
+        !in.read(reinterpret_cast<char*>(events.type.data()), n * sizeof(uint32_t)) ||
+        !in.read(reinterpret_cast<char*>(events.active.data()), n * sizeof(uint8_t)))
+      return false;
+    for (uint32_t t : events.type)
+    {
+      if (t >= events.names.size())
+        return false;
+    }
+    return true;
+  }
+
+  bool GetFirstActiveTime(const std::string& filename, const std::string& name, double& time_s)
+  {
+    std::vector<IndexEntry> index;
+    if (!ReadIndex(filename, index))
+      return false;
+    time_s = std::numeric_limits<double>::quiet_NaN();
+    for (const IndexEntry& e : index)
+    {
+      if (e.name == name)
+        time_s = e.firstActive_s;
+    }
+    return true;
+  }
+}
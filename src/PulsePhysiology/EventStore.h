@@ -0,0 +1,55 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Binary columnar file of the events of a run, written next to its results file
+///
+/// The file starts with an index of the events that occurred, so the first time of an event
+/// can be looked up across many runs by only reading the beginning of each file:
+///   char[8]  magic "PPEVENTS"
+///   uint32   version
+///   uint32   number of event types
+///   for each event type : uint32 name length, followed by the name (i.e. Patient.Asystole),
+///                         float64 time in seconds it first became active (NaN if it never did),
+///                         uint32 number of records of this event
+///   uint64   number of records
+/// It is followed by the records, stored column by column, in the order they were received:
+///   float64  simulation time in seconds, for each record
+///   uint32   event type, the index of its name, for each record
+///   uint8    1 if the event became active, 0 if it became inactive, for each record
+/// Values are stored in the native byte order.
+namespace EventStore
+{
+  static const char     Magic[8] = { 'P', 'P', 'E', 'V', 'E', 'N', 'T', 'S' };
+  static const uint32_t Version = 1;
+
+  /// The records of a run, one entry per record in each column
+  struct Events
+  {
+    std::vector<std::string> names;   // Name of each event type
+    std::vector<double> time_s;
+    std::vector<uint32_t> type;       // Index in names
+    std::vector<uint8_t> active;
+  };
+
+  /// Index entry of an event type
+  struct IndexEntry
+  {
+    std::string name;
+    double firstActive_s;             // NaN if the event never became active
+    uint32_t count;
+  };
+
+  bool Write(const std::string& filename, const Events& events);
+  /// Reads the index only
+  bool ReadIndex(const std::string& filename, std::vector<IndexEntry>& index);
+  /// Reads every record
+  bool Read(const std::string& filename, Events& events);
+  /// The first time the named event became active in the run, from its index,
+  /// NaN if it never did, returns false if the file could not be read
+  bool GetFirstActiveTime(const std::string& filename, const std::string& name, double& time_s);
+}
@@ -0,0 +1,119 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// A fixed set of worker threads, each with its own job queue.
+/// A worker takes jobs from the front of its own queue, and when that queue is empty
+/// it steals from the front of the other workers' queues.
+/// Jobs are expected to be long (an entire engine run), so the cost of a mutex per queue
+/// is negligible, what matters is that no worker sits idle while another has a backlog.
+/// Jobs can run pools of their own, i.e. a sweep forking its variants, the threads available to the creator
+/// of a pool are shared evenly between its workers, so nested pools do not oversubscribe the cores.
+class JobPool
+{
+public:
+  struct Job
+  {
+    std::function<void()> run;
+    double cost;  // Larger cost jobs are started first
+  };
+
+  JobPool(size_t numThreads = 0)
+  {
+    size_t available = GetAvailableThreads();
+    if (numThreads == 0)
+      numThreads = available;
+    m_WorkerBudget = std::max<size_t>(1, available / numThreads);
+    for (size_t i = 0; i < numThreads; i++)
+      m_Queues.emplace_back(new Queue());
+  }
+  ~JobPool() { }
+
+  size_t GetNumThreads() const { return m_Queues.size(); }
+
+  /// Number of threads the code running on this thread may use, every core outside of a pool
+  static size_t GetAvailableThreads()
+  {
+    size_t budget = GetThreadBudget();
+    return budget != 0 ? budget : std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  void Add(std::function<void()> run, double cost = 0)
+  {
+    m_Pending.push_back({ run, cost });
+  }
+
+  /// Runs all added jobs, longest first, and returns once they are all complete
+  void Run()
+  {
+    // Sort longest first, then deal the jobs out round robin.
+    // Every queue is then sorted longest first, and since thieves also take from the front
+    // of a queue, the longest job that is not running yet is always the next one to start
+    std::stable_sort(m_Pending.begin(), m_Pending.end(),
+      [](const Job& a, const Job& b) { return a.cost > b.cost; });
+    for (size_t i = 0; i < m_Pending.size(); i++)
+      m_Queues[i % m_Queues.size()]->jobs.push_back(m_Pending[i]);
+    m_Pending.clear();
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < m_Queues.size(); i++)
+      threads.emplace_back(&JobPool::Work, this, i);
+    for (std::thread& t : threads)
+      t.join();
+  }
+
+private:
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  bool Take(size_t queue, Job& job)
+  {
+    Queue& q = *m_Queues[queue];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.jobs.empty())
+      return false;
+    job = std::move(q.jobs.front());
+    q.jobs.pop_front();
+    return true;
+  }
+
+  // Threads available to the jobs of the calling worker, 0 outside of a pool
+  static size_t& GetThreadBudget()
+  {
+    static thread_local size_t budget = 0;
+    return budget;
+  }
+
+  void Work(size_t self)
+  {
+    GetThreadBudget() = m_WorkerBudget;
+    Job job;
+    for (;;)
+    {
+      bool found = Take(self, job);
+      // Nothing left of our own, steal from the other workers
+      for (size_t i = 1; !found && i < m_Queues.size(); i++)
+        found = Take((self + i) % m_Queues.size(), job);
+      // No new jobs are added while running, so if every queue is empty we are done
+      if (!found)
+        return;
+      job.run();
+    }
+  }
+
+  std::vector<Job> m_Pending;
+  std::vector<std::unique_ptr<Queue>> m_Queues;
+  size_t m_WorkerBudget; // Threads available to the jobs of each worker
+};
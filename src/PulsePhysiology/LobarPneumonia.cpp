@@ -23,6 +23,32 @@
 #include "properties/SEScalarVolumePerTime.h"
 #include "properties/SEScalar0To1.h"
 
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// The Lobar Pneumonia condition applied to the patient in this how-to
+//--------------------------------------------------------------------------------------------------
+void SetupLobarPneumonia(SELobarPneumonia& lobarPneumonia)
+{
+  lobarPneumonia.GetSeverity().SetValue(0.2);
+  lobarPneumonia.GetLeftLungAffected().SetValue(1.0);
+  lobarPneumonia.GetRightLungAffected().SetValue(1.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Stabilizes the patient with the Lobar Pneumonia condition and saves it to the stabilized state library
+//--------------------------------------------------------------------------------------------------
+void StabilizeLobarPneumonia()
+{
+  PooledEngine pe = CreateScenarioEngine("LobarPneumoniaStabilization.log");
+  SELobarPneumonia lobarPneumonia;
+  SetupLobarPneumonia(lobarPneumonia);
+  std::vector<const SECondition*> conditions;
+  conditions.push_back(&lobarPneumonia);
+  if (!InitializeEngineFromLibrary(*pe, "StandardMale.pba", conditions))
+    pe->GetLogger()->Error("Could not load initialize engine, check the error");
+}
+
 //--------------------------------------------------------------------------------------------------
 /// \brief
 /// Usage for applying a Lobar Pneumonia condition to the patient
@@ -33,21 +59,21 @@
 void HowToLobarPneumonia()
 {
   // Create the engine and load the patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("LobarPneumonia.log");
-  pe->GetLogger()->Info("HowToLobarPneumonia");
+  PooledEngine pe = CreateScenarioEngine("LobarPneumonia.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToLobarPneumonia");
   
   // Lobar pneumonia is a form of pneumonia that affects one or more lobes of the lungs.  
   // As fluid fills portions of the lung it becomes more difficult to breath and the gas diffusion surface area in the alveoli is reduced. 
   // Since this is a condition, we need to initialize it on the patient along with engine initialization
+  // The stabilized state is saved in the state library the first time,
+  // following runs with the same condition parameters load it instead of stabilizing again
 
   SELobarPneumonia lobarPneumonia;
-  lobarPneumonia.GetSeverity().SetValue(0.2);
-  lobarPneumonia.GetLeftLungAffected().SetValue(1.0);
-  lobarPneumonia.GetRightLungAffected().SetValue(1.0);
+  SetupLobarPneumonia(lobarPneumonia);
   std::vector<const SECondition*> conditions;
   conditions.push_back(&lobarPneumonia);
 
-  if (!pe->InitializeEngine("StandardMale.pba", &conditions))
+  if (!InitializeEngineFromLibrary(*pe, "StandardMale.pba", conditions))
   {
     pe->GetLogger()->Error("Could not load initialize engine, check the error");
     return;
@@ -70,17 +96,23 @@ void HowToLobarPneumonia()
 
   pe->GetEngineTracker()->GetDataRequestManager().SetResultsFilename("LobarPneumonia.csv");
 
+  // The condition is active from the start
+  tracker.SetPhase(ScenarioPhase::InsultActive);
+  // The patient was stabilized with the condition, the run can stop once the vitals settle
+  std::unique_ptr<SteadyStateStop> steadyState = SteadyStateStop::Create<SteadyStateVitals>(*pe);
+  tracker.AddStopCondition(*steadyState);
+
   // Advance some time to get some data
   tracker.AdvanceModelTime(500);
 
-  pe->GetLogger()->Info("The patient is not very healthy");
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() <<"Hemoglobin Content : " << pe->GetBloodChemistrySystem()->GetHemoglobinContent(MassUnit::g) << MassUnit::g);
-  pe->GetLogger()->Info(std::stringstream() <<"Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"InspiratoryExpiratoryRatio : " << pe->GetRespiratorySystem()->GetInspiratoryExpiratoryRatio());
-  pe->GetLogger()->Info(std::stringstream() <<"Carina InFlow : " << pe->GetCompartments().GetGasCompartment(pulse::PulmonaryCompartment::Carina)->GetInFlow(VolumePerTimeUnit::L_Per_s) << VolumePerTimeUnit::L_Per_s);;
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is not very healthy");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cardiac Output : {}{}", pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Hemoglobin Content : {}{}", pe->GetBloodChemistrySystem()->GetHemoglobinContent(MassUnit::g), MassUnit::g);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "InspiratoryExpiratoryRatio : {}", pe->GetRespiratorySystem()->GetInspiratoryExpiratoryRatio());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carina InFlow : {}{}", pe->GetCompartments().GetGasCompartment(pulse::PulmonaryCompartment::Carina)->GetInFlow(VolumePerTimeUnit::L_Per_s), VolumePerTimeUnit::L_Per_s);;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
@@ -0,0 +1,86 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+
+#include "EngineUse.h"
+#include "PatientHost.h"
+
+// Include the various types you will be using in your code
+#include "patient/actions/SEAirwayObstruction.h"
+#include "patient/actions/SETensionPneumothorax.h"
+#include "properties/SEScalar0To1.h"
+#include "properties/SEScalarTime.h"
+#include "utils/Logger.h"
+#include <fstream>
+
+/// Number of patients of the mass casualty exercise
+inline size_t& MassCasualtyNumPatients()
+{
+  static size_t numPatients = 200;
+  return numPatients;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Usage for running the patients of a mass casualty exercise in real time, in one process
+///
+/// \details
+/// Refer to the PatientHost class
+/// A third of the patients stay healthy, a third get a tension pneumothorax and a third an airway obstruction,
+/// of increasing severity. The real time statistics of each patient are written to MassCasualtyLag.csv.
+//--------------------------------------------------------------------------------------------------
+void HowToMassCasualty()
+{
+  ScenarioFiles::AddOutput("MassCasualty.log");
+  Logger logger("MassCasualty.log");
+  BinaryLog::RegisterSource(&logger, "MassCasualty.log");
+  size_t numPatients = MassCasualtyNumPatients();
+  SCENARIO_LOG_INFO(&logger, "HowToMassCasualty, {} patients", numPatients);
+
+  // Every patient has its own engine and log, the host steps them on a worker per core
+  PatientHost host;
+  for (size_t i = 0; i < numPatients; i++)
+  {
+    PooledEngine pe = CreateScenarioEngine("MassCasualty_" + std::to_string(i) + ".log");
+    pe->GetLogger()->LogToConsole(false);
+    if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
+    {
+      logger.Error("Could not load state, check the error");
+      return;
+    }
+    double severity = 0.3 + 0.6 * i / numPatients;
+    if (i % 3 == 1)
+    {
+      SETensionPneumothorax pneumo;
+      pneumo.SetType(cdm::eGate::Closed);
+      pneumo.SetSide(cdm::eSide::Right);
+      pneumo.GetSeverity().SetValue(severity);
+      pe->ProcessAction(pneumo);
+    }
+    else if (i % 3 == 2)
+    {
+      SEAirwayObstruction obstruction;
+      obstruction.GetSeverity().SetValue(severity);
+      pe->ProcessAction(obstruction);
+    }
+    host.Add(std::move(pe));
+  }
+
+  SCENARIO_LOG_INFO(&logger, "Running {} patients on {} threads for 60s", numPatients, host.GetNumThreads());
+  host.Run(60);
+
+  size_t misses = 0, dropped = 0;
+  double worstLag_s = 0;
+  for (size_t i = 0; i < numPatients; i++)
+  {
+    const RealTimeStats& stats = host.GetStats(i);
+    misses += stats.deadlineMisses;
+    dropped += stats.droppedSteps;
+    worstLag_s = std::max(worstLag_s, stats.worstLag_s);
+  }
+  SCENARIO_LOG_INFO(&logger, "Deadline misses : {}, dropped steps : {}, worst lag : {}ms, steals : {}",
+                    misses, dropped, worstLag_s * 1e3, host.GetNumSteals());
+  ScenarioFiles::AddOutput("MassCasualtyLag.csv");
+  std::ofstream lag("MassCasualtyLag.csv");
+  host.WriteStats(lag);
+  SCENARIO_LOG_INFO(&logger, "Finished");
+}
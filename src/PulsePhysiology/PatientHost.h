@@ -0,0 +1,255 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "properties/SEScalarTime.h"
+#include "EngineFork.h"
+#include "EnginePool.h"
+#include "RealTimePacer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+/// Runs many engines in real time in one process, i.e. the patients of a mass casualty exercise
+/// The engines are multiplexed on a fixed set of worker threads. Each worker keeps its patients in a heap
+/// ordered by the wall clock deadline of their next time step, and always steps the earliest deadline first.
+/// A worker with no patient due steals the most overdue patient of the other workers, which then stays with it,
+/// so the load balances itself across cores. Like the RealTimePacer, a patient too far behind to catch up
+/// within the burst limit has its schedule moved forward, and the steps skipped are counted as dropped.
+/// The lag of each patient, the delay between a step deadline and the start of that step, is tracked
+/// in its RealTimeStats, and the latest lag can be read from any thread while the host runs.
+/// The workers record their steps in the metrics and profile of the scenario running the host, if any.
+class PatientHost
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  PatientHost(size_t numThreads = 0, size_t maxBurst = 10) : m_MaxBurst(maxBurst), m_Remaining(0), m_Steals(0)
+  {
+    if (numThreads == 0)
+      numThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < numThreads; i++)
+      m_Workers.emplace_back(new Worker());
+  }
+
+  size_t GetNumThreads() const { return m_Workers.size(); }
+  size_t GetNumPatients() const { return m_Patients.size(); }
+
+  /// Adds a patient, the host owns its engine, returns the index of the patient
+  size_t Add(PooledEngine engine)
+  {
+    m_Patients.emplace_back(new Patient(std::move(engine)));
+    return m_Patients.size() - 1;
+  }
+
+  /// The engine of a patient, only to be used while the host is not running
+  PhysiologyEngine& GetEngine(size_t patient) { return *m_Patients[patient]->engine; }
+
+  /// Advances every patient by the given simulated time, in lockstep with the wall clock, returns once they all have
+  void Run(double duration_s)
+  {
+    if (m_Patients.empty())
+      return;
+    // Spread the first deadlines over a time step, so the patients do not all come due at once
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < m_Patients.size(); i++)
+    {
+      Patient& p = *m_Patients[i];
+      p.stepsLeft = static_cast<size_t>(std::lround(duration_s / p.dT_s));
+      p.deadline = start + p.dT * static_cast<Clock::rep>(i) / static_cast<Clock::rep>(m_Patients.size());
+      Worker& w = *m_Workers[i % m_Workers.size()];
+      w.heap.push_back(&p);
+      std::push_heap(w.heap.begin(), w.heap.end(), LaterDeadline);
+    }
+    for (std::unique_ptr<Worker>& w : m_Workers)
+      w->UpdateEarliest();
+    m_Remaining = m_Patients.size();
+
+    // The workers record their files, profile and metrics in the ones of the calling thread
+    ScenarioContext context;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < m_Workers.size(); i++)
+      threads.emplace_back(&PatientHost::Work, this, i, std::ref(context));
+    for (std::thread& t : threads)
+      t.join();
+    for (std::unique_ptr<Worker>& w : m_Workers)
+      w->heap.clear();
+  }
+
+  /// The lag of the last step of a patient, in seconds, can be read from any thread
+  double GetLag_s(size_t patient) const { return m_Patients[patient]->lag_s.load(std::memory_order_relaxed); }
+  /// The real time statistics of a patient, only to be used while the host is not running
+  const RealTimeStats& GetStats(size_t patient) const { return m_Patients[patient]->stats; }
+  /// Number of times a worker stepped a patient of another worker
+  size_t GetNumSteals() const { return m_Steals; }
+
+  /// Writes the real time statistics of each patient, as csv
+  void WriteStats(std::ostream& out) const
+  {
+    out << "Patient,Steps,DeadlineMisses,DroppedSteps,MeanLag(ms),Jitter(ms),WorstLag(ms)\n";
+    for (size_t i = 0; i < m_Patients.size(); i++)
+    {
+      const RealTimeStats& s = m_Patients[i]->stats;
+      out << i << "," << s.steps << "," << s.deadlineMisses << "," << s.droppedSteps << "," << s.GetMeanLag_s() * 1e3
+          << "," << s.GetJitter_s() * 1e3 << "," << s.worstLag_s * 1e3 << "\n";
+    }
+  }
+
+protected:
+  struct Patient
+  {
+    Patient(PooledEngine e) : engine(std::move(e)), stepsLeft(0), lag_s(0)
+    {
+      dT_s = engine->GetTimeStep(TimeUnit::s);
+      dT = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dT_s));
+    }
+
+    PooledEngine engine;
+    double dT_s;
+    Clock::duration dT;
+    Clock::time_point deadline;  // Of the next step
+    size_t stepsLeft;
+    RealTimeStats stats;         // Only used by the worker stepping the patient
+    std::atomic<double> lag_s;
+  };
+
+  // A patient is in exactly one heap, or being stepped by the worker that took it out
+  struct Worker
+  {
+    std::mutex mutex;
+    std::vector<Patient*> heap;
+    std::atomic<Clock::rep> earliest; // Deadline of the top of the heap, so thieves can pick a victim without locking
+
+    // Call with the mutex locked
+    void UpdateEarliest()
+    {
+      earliest.store(heap.empty() ? std::numeric_limits<Clock::rep>::max() : heap.front()->deadline.time_since_epoch().count(),
+                     std::memory_order_relaxed);
+    }
+    // Takes the top of the heap if it is due, call with the mutex locked
+    Patient* TakeDue(Clock::time_point now)
+    {
+      if (heap.empty() || heap.front()->deadline > now)
+        return nullptr;
+      std::pop_heap(heap.begin(), heap.end(), LaterDeadline);
+      Patient* p = heap.back();
+      heap.pop_back();
+      UpdateEarliest();
+      return p;
+    }
+  };
+
+  static bool LaterDeadline(const Patient* a, const Patient* b) { return a->deadline > b->deadline; }
+  // Longest a worker sleeps before looking for patients to steal again
+  static Clock::duration GetMaxSleep() { return std::chrono::milliseconds(1); }
+
+  void Work(size_t self, ScenarioContext& context)
+  {
+    ScenarioContext::Scope scope(context);
+    Worker& own = *m_Workers[self];
+    while (m_Remaining.load(std::memory_order_acquire) > 0)
+    {
+      Clock::time_point now = Clock::now();
+      Patient* p;
+      Clock::time_point next;
+      {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        p = own.TakeDue(now);
+        next = own.heap.empty() ? now + GetMaxSleep() : own.heap.front()->deadline;
+      }
+      if (p == nullptr)
+        p = Steal(self, now);
+      if (p == nullptr)
+      {
+        // Wake up often enough to help the other workers
+        std::this_thread::sleep_until(std::min(next, now + GetMaxSleep()));
+        continue;
+      }
+
+      Step(*p, now);
+      if (p->stepsLeft == 0)
+      {
+        m_Remaining.fetch_sub(1, std::memory_order_acq_rel);
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(own.mutex);
+      own.heap.push_back(p);
+      std::push_heap(own.heap.begin(), own.heap.end(), LaterDeadline);
+      own.UpdateEarliest();
+    }
+  }
+
+  /// Takes the most overdue patient of the other workers, nullptr if none is due
+  Patient* Steal(size_t self, Clock::time_point now)
+  {
+    size_t victim = self;
+    Clock::rep earliest = now.time_since_epoch().count();
+    for (size_t i = 1; i < m_Workers.size(); i++)
+    {
+      size_t w = (self + i) % m_Workers.size();
+      Clock::rep deadline = m_Workers[w]->earliest.load(std::memory_order_relaxed);
+      if (deadline <= earliest)
+      {
+        earliest = deadline;
+        victim = w;
+      }
+    }
+    if (victim == self)
+      return nullptr;
+    Worker& w = *m_Workers[victim];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    Patient* p = w.TakeDue(now);
+    if (p != nullptr)
+      m_Steals.fetch_add(1, std::memory_order_relaxed);
+    return p;
+  }
+
+  void Step(Patient& p, Clock::time_point now)
+  {
+    Clock::duration lag = now - p.deadline;
+    double lag_s = std::chrono::duration<double>(lag).count();
+    p.stats.Record(lag_s, p.dT_s);
+    p.lag_s.store(lag_s, std::memory_order_relaxed);
+    if (lag > p.dT * static_cast<Clock::rep>(m_MaxBurst))
+    {
+      // Too far behind to catch up, give up on the steps past the burst limit
+      size_t dropped = static_cast<size_t>(lag / p.dT) - m_MaxBurst;
+      p.stats.droppedSteps += dropped;
+      p.deadline += p.dT * static_cast<Clock::rep>(dropped);
+    }
+
+    // Only time steps when a benchmark is collecting metrics
+    ScenarioMetrics* metrics = ScenarioMetrics::Current();
+    ScenarioMetrics::Clock::time_point start;
+    if (metrics != nullptr)
+      start = ScenarioMetrics::Clock::now();
+    {
+      ScopedCallTimer timer(EngineCall::AdvanceModelTime);
+      p.engine->AdvanceModelTime();
+    }
+    if (metrics != nullptr)
+    {
+      double latency_s = ScenarioMetrics::Seconds(start, ScenarioMetrics::Clock::now());
+      metrics->stepLatencies_s.push_back(latency_s);
+      metrics->stepping_s += latency_s;
+      metrics->simTime_s += p.dT_s;
+    }
+    p.deadline += p.dT;
+    p.stepsLeft--;
+  }
+
+  size_t m_MaxBurst;
+  std::vector<std::unique_ptr<Patient>> m_Patients;
+  std::vector<std::unique_ptr<Worker>> m_Workers;
+  std::atomic<size_t> m_Remaining;
+  std::atomic<size_t> m_Steals;
+};
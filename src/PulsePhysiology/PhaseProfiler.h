@@ -0,0 +1,204 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+/// Latency histogram with a bounded relative error, in the spirit of HdrHistogram
+/// Values are recorded in nanoseconds, below 2^SubBits they are recorded exactly,
+/// above that each power of 2 is split in 2^SubBits linear buckets, so any recorded value
+/// is reported within 1/2^SubBits (about 3%) of its actual value, from nanoseconds to hours.
+/// Recording is a couple of shifts and an increment, no allocation.
+class LatencyHistogram
+{
+public:
+  static const int SubBits = 5;
+  static const int SubCount = 1 << SubBits;
+  static const int NumBuckets = SubCount + (64 - SubBits) * SubCount;
+
+  LatencyHistogram() { Reset(); }
+
+  void Reset()
+  {
+    for (int i = 0; i < NumBuckets; i++)
+      m_Counts[i] = 0;
+    m_Count = 0;
+    m_Total_ns = 0;
+    m_Max_ns = 0;
+  }
+
+  void Record(uint64_t value_ns)
+  {
+    m_Counts[GetBucket(value_ns)]++;
+    m_Count++;
+    m_Total_ns += value_ns;
+    if (value_ns > m_Max_ns)
+      m_Max_ns = value_ns;
+  }
+
+  /// Adds the values recorded by another histogram
+  void Merge(const LatencyHistogram& other)
+  {
+    for (int i = 0; i < NumBuckets; i++)
+      m_Counts[i] += other.m_Counts[i];
+    m_Count += other.m_Count;
+    m_Total_ns += other.m_Total_ns;
+    if (other.m_Max_ns > m_Max_ns)
+      m_Max_ns = other.m_Max_ns;
+  }
+
+  uint64_t GetCount() const { return m_Count; }
+  double GetTotal_s() const { return m_Total_ns * 1e-9; }
+  double GetMean_s() const { return m_Count == 0 ? 0 : (m_Total_ns * 1e-9) / m_Count; }
+  double GetMax_s() const { return m_Max_ns * 1e-9; }
+  /// Returns the given percentile (0 to 1), as the upper bound of the bucket it falls into
+  double GetPercentile_s(double p) const
+  {
+    if (m_Count == 0)
+      return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p * m_Count));
+    if (rank == 0)
+      rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < NumBuckets; i++)
+    {
+      seen += m_Counts[i];
+      if (seen >= rank)
+        return std::fmin(static_cast<double>(GetBucketUpperBound(i)), static_cast<double>(m_Max_ns)) * 1e-9;
+    }
+    return GetMax_s();
+  }
+
+protected:
+  static int GetBucket(uint64_t v)
+  {
+    if (v < SubCount)
+      return static_cast<int>(v);
+    int msb = 63;
+    while (!(v >> msb))
+      msb--;
+    int shift = msb - SubBits;
+    return SubCount + shift * SubCount + static_cast<int>((v >> shift) & (SubCount - 1));
+  }
+  static uint64_t GetBucketUpperBound(int bucket)
+  {
+    if (bucket < SubCount)
+      return static_cast<uint64_t>(bucket);
+    int shift = (bucket - SubCount) / SubCount;
+    uint64_t sub = static_cast<uint64_t>((bucket - SubCount) % SubCount);
+    return ((SubCount + sub + 1) << shift) - 1;
+  }
+
+  uint64_t m_Counts[NumBuckets];
+  uint64_t m_Count;
+  uint64_t m_Total_ns;
+  uint64_t m_Max_ns;
+};
+
+/// The phases of a how-to scenario
+enum class ScenarioPhase { HealthyWarmUp = 0, InsultActive, AfterIntervention, Count };
+/// The engine calls made by the how-to scenarios
+enum class EngineCall { ProcessAction = 0, AdvanceModelTime, TrackData, Logger, Count };
+
+/// Collects the time spent in each engine call, for each phase of a scenario
+/// Like ScenarioMetrics, nothing is recorded unless a profiler is installed on the running thread.
+class PhaseProfiler
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  PhaseProfiler() : m_Phase(ScenarioPhase::HealthyWarmUp) { }
+
+  /// The profiler of the scenario running on this thread, nullptr if the scenario is not profiled
+  static PhaseProfiler*& Current()
+  {
+    static thread_local PhaseProfiler* current = nullptr;
+    return current;
+  }
+
+  void SetPhase(ScenarioPhase phase) { m_Phase = phase; }
+  ScenarioPhase GetPhase() const { return m_Phase; }
+
+  void Record(EngineCall call, Clock::duration d)
+  {
+    m_Histograms[static_cast<int>(m_Phase)][static_cast<int>(call)].Record(
+      static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()));
+  }
+
+  /// Adds the calls recorded by another profiler, i.e. of an engine forked on another thread
+  void Merge(const PhaseProfiler& other)
+  {
+    for (int p = 0; p < static_cast<int>(ScenarioPhase::Count); p++)
+      for (int c = 0; c < static_cast<int>(EngineCall::Count); c++)
+        m_Histograms[p][c].Merge(other.m_Histograms[p][c]);
+  }
+
+  const LatencyHistogram& GetHistogram(ScenarioPhase phase, EngineCall call) const
+  {
+    return m_Histograms[static_cast<int>(phase)][static_cast<int>(call)];
+  }
+
+  static const char* GetName(ScenarioPhase phase)
+  {
+    static const char* names[] = { "HealthyWarmUp", "InsultActive", "AfterIntervention" };
+    return names[static_cast<int>(phase)];
+  }
+  static const char* GetName(EngineCall call)
+  {
+    static const char* names[] = { "ProcessAction", "AdvanceModelTime", "TrackData", "Logger" };
+    return names[static_cast<int>(call)];
+  }
+
+  /// Writes a table of the calls made in each phase, times are in microseconds
+  void Write(std::ostream& out) const
+  {
+    out << std::left << std::setw(20) << "Phase" << std::setw(18) << "Call"
+        << std::right << std::setw(10) << "Count" << std::setw(12) << "Total(s)"
+        << std::setw(12) << "Mean(us)" << std::setw(12) << "p50(us)" << std::setw(12) << "p90(us)"
+        << std::setw(12) << "p99(us)" << std::setw(12) << "Max(us)" << "\n";
+    for (int p = 0; p < static_cast<int>(ScenarioPhase::Count); p++)
+    {
+      for (int c = 0; c < static_cast<int>(EngineCall::Count); c++)
+      {
+        const LatencyHistogram& h = m_Histograms[p][c];
+        if (h.GetCount() == 0)
+          continue;
+        out << std::left << std::setw(20) << GetName(static_cast<ScenarioPhase>(p))
+            << std::setw(18) << GetName(static_cast<EngineCall>(c)) << std::right
+            << std::setw(10) << h.GetCount() << std::setw(12) << std::fixed << std::setprecision(3) << h.GetTotal_s()
+            << std::setw(12) << h.GetMean_s() * 1e6 << std::setw(12) << h.GetPercentile_s(0.5) * 1e6
+            << std::setw(12) << h.GetPercentile_s(0.9) * 1e6 << std::setw(12) << h.GetPercentile_s(0.99) * 1e6
+            << std::setw(12) << h.GetMax_s() * 1e6 << "\n";
+      }
+    }
+  }
+
+protected:
+  ScenarioPhase m_Phase;
+  LatencyHistogram m_Histograms[static_cast<int>(ScenarioPhase::Count)][static_cast<int>(EngineCall::Count)];
+};
+
+/// Records the time spent in its scope as the given engine call, if the scenario is being profiled
+class ScopedCallTimer
+{
+public:
+  ScopedCallTimer(EngineCall call) : m_Profiler(PhaseProfiler::Current()), m_Call(call)
+  {
+    if (m_Profiler != nullptr)
+      m_Start = PhaseProfiler::Clock::now();
+  }
+  ~ScopedCallTimer()
+  {
+    if (m_Profiler != nullptr)
+      m_Profiler->Record(m_Call, PhaseProfiler::Clock::now() - m_Start);
+  }
+
+private:
+  PhaseProfiler* m_Profiler;
+  EngineCall m_Call;
+  PhaseProfiler::Clock::time_point m_Start;
+};
@@ -32,9 +32,9 @@
 void HowToPulmonaryFunctionTest()
 {
   // Create the engine and load the patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("PulmonaryFunctionTest.log");
-  pe->GetLogger()->Info("HowToPulmonaryFunctionTest");
-  if (!pe->LoadStateFile("./states/StandardMale@0s.pba"))
+  PooledEngine pe = CreateScenarioEngine("PulmonaryFunctionTest.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToPulmonaryFunctionTest");
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
   {
     pe->GetLogger()->Error("Could not load state, check the error");
     return;
@@ -66,24 +66,24 @@ void HowToPulmonaryFunctionTest()
   SEPulmonaryFunctionTest pft(pe->GetLogger());
   pe->GetPatientAssessment(pft);
 
-  pe->GetLogger()->Info("Performing PFT at time 0s");
-  pe->GetLogger()->Info("Currently these are the PFT properties computed by the Pulse engine");
-  pe->GetLogger()->Info(std::stringstream() <<"Expiratory Reserve Volume"    << pft.GetExpiratoryReserveVolume()  ); 
-  pe->GetLogger()->Info(std::stringstream() <<"Functional Residual Capacity" << pft.GetFunctionalResidualCapacity());
-  pe->GetLogger()->Info(std::stringstream() <<"Inspiratory Capacity"         << pft.GetInspiratoryCapacity()      );
-  pe->GetLogger()->Info(std::stringstream() <<"Inspiratory Reserve Volume"   << pft.GetInspiratoryReserveVolume() );
-  pe->GetLogger()->Info(std::stringstream() <<"Residual Volume"              << pft.GetResidualVolume()           );
-  pe->GetLogger()->Info(std::stringstream() <<"Total Lung Capacity"          << pft.GetTotalLungCapacity()        );
-  pe->GetLogger()->Info(std::stringstream() <<"Vital Capacity"               << pft.GetVitalCapacity()            );
-  pe->GetLogger()->Info("Currently, Pulse does not support calculation of the following values:");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Performing PFT at time 0s");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Currently these are the PFT properties computed by the Pulse engine");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Expiratory Reserve Volume{}", pft.GetExpiratoryReserveVolume()); 
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Functional Residual Capacity{}", pft.GetFunctionalResidualCapacity());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Inspiratory Capacity{}", pft.GetInspiratoryCapacity());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Inspiratory Reserve Volume{}", pft.GetInspiratoryReserveVolume());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Residual Volume{}", pft.GetResidualVolume());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Total Lung Capacity{}", pft.GetTotalLungCapacity());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Vital Capacity{}", pft.GetVitalCapacity());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Currently, Pulse does not support calculation of the following values:");
 
   // Values will be NaN
-  pe->GetLogger()->Info(std::stringstream() <<"Forced Vital Capacity"        << pft.GetForcedVitalCapacity()       );
-  pe->GetLogger()->Info(std::stringstream() <<"Forced Expiratory Volume"     << pft.GetForcedExpiratoryVolume()    );
-  pe->GetLogger()->Info(std::stringstream() <<"Forced Expiratory Flow"       << pft.GetForcedExpiratoryFlow()      );
-  pe->GetLogger()->Info(std::stringstream() <<"Maximum Voluntary Ventilation"<< pft.GetMaximumVoluntaryVentilation());
-  pe->GetLogger()->Info(std::stringstream() <<"Peak Expiratory Flow"         << pft.GetPeakExpiratoryFlow()        );
-  pe->GetLogger()->Info(std::stringstream() <<"Slow Vital Capacity"          << pft.GetSlowVitalCapacity()         );
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Forced Vital Capacity{}", pft.GetForcedVitalCapacity());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Forced Expiratory Volume{}", pft.GetForcedExpiratoryVolume());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Forced Expiratory Flow{}", pft.GetForcedExpiratoryFlow());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Maximum Voluntary Ventilation{}", pft.GetMaximumVoluntaryVentilation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Peak Expiratory Flow{}", pft.GetPeakExpiratoryFlow());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Slow Vital Capacity{}", pft.GetSlowVitalCapacity());
   
   // Pulse does compute the LungVolumePlot Data
   //The resulting plot is obtained which displays lung volume as a function of time 
@@ -93,5 +93,5 @@ void HowToPulmonaryFunctionTest()
   lungVolumePlot.GetTime(); //This is the time component of the pulmonary function test
   lungVolumePlot.GetVolume(); //This is the lung volume component of the pulmonary function test
   // This is intended to be a a data form that can easily be plotted.
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
\ No newline at end of file
@@ -0,0 +1,322 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2018 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <PulsePhysiology/DataRequestSource.h>
+#include <PulsePhysiology/PulsePatient.h>
+#include <PulsePhysiology/StateCache.h>
+#include <PulsePhysiology/VitalsSnapshot.h>
+
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/simulation/AnimateBeginEvent.h>
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "properties/SEScalarTime.h"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+
+namespace sofa
+{
+namespace pulsephysiology
+{
+
+PulsePatient::PulsePatient()
+    : d_stateFile(initData(&d_stateFile, std::string("./states/StandardMale@0s.pba"), "stateFile", "Pulse state the patient starts from"))
+    , d_logFile(initData(&d_logFile, std::string("PulsePatient.log"), "logFile", "Log file of the Pulse engine"))
+    , d_interpolate(initData(&d_interpolate, true, "interpolate", "Interpolate the outputs at the animation time, rather than keeping the last values computed"))
+    , d_maxExtrapolation(initData(&d_maxExtrapolation, 0.1, "maxExtrapolation", "How far past the last values computed the outputs are extrapolated when the engine is late (s)"))
+    , d_dataRequests(initData(&d_dataRequests, "dataRequests", "Data requests published as outputs, [Compartment-]Property[(unit)], i.e. HeartRate(1/min) Brain-InFlow(mL/min)"))
+    , d_physiologyTime(initData(&d_physiologyTime, 0.0, "physiologyTime", "Simulation time of the published values (s)"))
+    , d_heartRate(initData(&d_heartRate, 0.0, "heartRate", "Heart rate (1/min)"))
+    , d_systolicArterialPressure(initData(&d_systolicArterialPressure, 0.0, "systolicArterialPressure", "Systolic arterial pressure (mmHg)"))
+    , d_diastolicArterialPressure(initData(&d_diastolicArterialPressure, 0.0, "diastolicArterialPressure", "Diastolic arterial pressure (mmHg)"))
+    , d_meanArterialPressure(initData(&d_meanArterialPressure, 0.0, "meanArterialPressure", "Mean arterial pressure (mmHg)"))
+    , d_respirationRate(initData(&d_respirationRate, 0.0, "respirationRate", "Respiration rate (1/min)"))
+    , d_tidalVolume(initData(&d_tidalVolume, 0.0, "tidalVolume", "Tidal volume (mL)"))
+    , d_totalLungVolume(initData(&d_totalLungVolume, 0.0, "totalLungVolume", "Total lung volume (mL)"))
+    , d_oxygenSaturation(initData(&d_oxygenSaturation, 0.0, "oxygenSaturation", "Oxygen saturation"))
+    , d_interpolationError(initData(&d_interpolationError, "interpolationError", "Estimated error of each interpolated output, in the order of the outputs above then of the data requests"))
+    , m_dt(0)
+    , m_running(false)
+    , m_targetTime(0)
+{
+    d_physiologyTime.setReadOnly(true);
+    d_heartRate.setReadOnly(true);
+    d_systolicArterialPressure.setReadOnly(true);
+    d_diastolicArterialPressure.setReadOnly(true);
+    d_meanArterialPressure.setReadOnly(true);
+    d_respirationRate.setReadOnly(true);
+    d_tidalVolume.setReadOnly(true);
+    d_totalLungVolume.setReadOnly(true);
+    d_oxygenSaturation.setReadOnly(true);
+    d_interpolationError.setReadOnly(true);
+    this->f_listening.setValue(true);
+}
+
+PulsePatient::~PulsePatient()
+{
+    stopWorker();
+}
+
+void PulsePatient::init()
+{
+    stopWorker();
+    m_engine = CreatePulseEngine(d_logFile.getValue());
+    if (!LoadCachedState(*m_engine, d_stateFile.getValue()))
+    {
+        msg_error() << "Could not load state " << d_stateFile.getValue() << ", check the Pulse log";
+        m_engine.reset();
+        return;
+    }
+    m_vitalsReader.reset(new VitalsReader(*m_engine));
+    m_dt = m_engine->GetTimeStep(TimeUnit::s);
+    createDataRequests();
+    updateDataRequests();
+}
+
+void PulsePatient::updateDataRequests()
+{
+    if (m_engine == nullptr)
+        return;
+    stopWorker();
+    m_requests.reset(new DataRequestSource());
+    if (!m_requests->Setup(*m_engine))
+        msg_warning() << "Some data requests cannot be sampled and are published as NaN, check the Pulse log";
+    createRequestOutputs();
+
+    size_t numChannels = NumOutputs + m_requests->GetNumChannels();
+    m_vitals.Reset(numChannels);
+    m_samples.assign(numChannels, 0.0);
+    m_values.assign(numChannels, 0.0);
+    m_errors.assign(numChannels, 0.0);
+    pushVitals();
+    publishVitals();
+    startWorker();
+}
+
+void PulsePatient::createDataRequests()
+{
+    // The manager may keep the unit of a request, so they live as long as the engine
+    m_requestUnits.clear();
+    SEDataRequestManager& manager = m_engine->GetEngineTracker()->GetDataRequestManager();
+    for (const std::string& request : d_dataRequests.getValue())
+    {
+        std::string property = request;
+        std::unique_ptr<CCompoundUnit> unit;
+        size_t open = property.find('(');
+        if (open != std::string::npos && property.back() == ')')
+        {
+            try
+            {
+                unit.reset(new CCompoundUnit(property.substr(open + 1, property.size() - open - 2)));
+            }
+            catch (const std::exception&)
+            {
+                msg_error() << "Invalid unit in data request " << request;
+                continue;
+            }
+            property = property.substr(0, open);
+        }
+        std::string compartment;
+        size_t dash = property.find('-');
+        if (dash != std::string::npos)
+        {
+            compartment = property.substr(0, dash);
+            property = property.substr(dash + 1);
+        }
+
+        if (compartment.empty())
+        {
+            if (unit == nullptr)
+                manager.CreatePhysiologyDataRequest(property);
+            else
+                manager.CreatePhysiologyDataRequest(property, *unit);
+        }
+        else if (m_engine->GetCompartments().GetGasCompartment(compartment) != nullptr)
+        {
+            if (unit == nullptr)
+                manager.CreateGasCompartmentDataRequest(compartment, property);
+            else
+                manager.CreateGasCompartmentDataRequest(compartment, property, *unit);
+        }
+        else
+        {
+            if (unit == nullptr)
+                manager.CreateLiquidCompartmentDataRequest(compartment, property);
+            else
+                manager.CreateLiquidCompartmentDataRequest(compartment, property, *unit);
+        }
+        if (unit != nullptr)
+            m_requestUnits.push_back(std::move(unit));
+    }
+}
+
+void PulsePatient::createRequestOutputs()
+{
+    // Outputs are named after the channel without its unit, with the characters a link path cannot hold replaced,
+    // i.e. Brain-InFlow(mL/min) is published as Brain_InFlow
+    std::vector<std::string> names;
+    for (size_t i = 0; i < m_requests->GetNumChannels(); i++)
+    {
+        std::string name = m_requests->GetChannelName(i);
+        name = name.substr(0, name.find('('));
+        for (char& c : name)
+        {
+            if (!std::isalnum(static_cast<unsigned char>(c)))
+                c = '_';
+        }
+        names.push_back(name);
+    }
+
+    // Keep the outputs that are still requested, so the links to them hold across a reset
+    bool same = names.size() == m_requestOutputs.size();
+    for (size_t i = 0; same && i < names.size(); i++)
+        same = m_requestOutputs[i]->data->getName() == names[i];
+    if (same)
+        return;
+    for (std::unique_ptr<RequestOutput>& output : m_requestOutputs)
+        this->removeData(output->data.get());
+    m_requestOutputs.clear();
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        std::unique_ptr<RequestOutput> output(new RequestOutput());
+        output->help = "Data request " + m_requests->GetChannelName(i);
+        output->data.reset(new Data<double>(output->help.c_str(), true, true));
+        this->addData(output->data.get(), names[i]);
+        m_requestOutputs.push_back(std::move(output));
+    }
+}
+
+void PulsePatient::reset()
+{
+    init();
+}
+
+void PulsePatient::cleanup()
+{
+    stopWorker();
+    m_vitalsReader.reset();
+    m_requests.reset();
+    m_engine.reset();
+    m_requestUnits.clear();
+}
+
+void PulsePatient::handleEvent(core::objectmodel::Event* event)
+{
+    if (!simulation::AnimateBeginEvent::checkEventType(event) || m_engine == nullptr)
+        return;
+    // The engine follows the animation time, it is asked to catch up with the end of the step being computed
+    publishVitals();
+    m_targetTime = this->getContext()->getTime() + this->getContext()->getDt();
+    m_wake.notify_one();
+}
+
+void PulsePatient::startWorker()
+{
+    m_targetTime = 0;
+    m_running = true;
+    m_worker = std::thread(&PulsePatient::work, this);
+}
+
+void PulsePatient::stopWorker()
+{
+    if (!m_running)
+        return;
+    m_running = false;
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+void PulsePatient::work()
+{
+    double time = m_engine->GetSimulationTime(TimeUnit::s);
+    while (m_running)
+    {
+        // Compute every engine step that ends before the target time, half a step of tolerance avoids drifting a step behind
+        if (time + 0.5 * m_dt <= m_targetTime)
+        {
+            m_engine->AdvanceModelTime();
+            time = m_engine->GetSimulationTime(TimeUnit::s);
+            pushVitals();
+            continue;
+        }
+        // The animation loop does not wait for us to be waiting, so do not sleep for long in case we missed its notification
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
+
+void PulsePatient::pushVitals()
+{
+    // All the values are read in one pass, straight from the engine scalars
+    const VitalsSnapshot& snapshot = m_vitalsReader->Read();
+    double* values = m_samples.data();
+    values[HeartRate] = snapshot.HeartRate;
+    values[SystolicArterialPressure] = snapshot.SystolicArterialPressure;
+    values[DiastolicArterialPressure] = snapshot.DiastolicArterialPressure;
+    values[MeanArterialPressure] = snapshot.MeanArterialPressure;
+    values[RespirationRate] = snapshot.RespirationRate;
+    values[TidalVolume] = snapshot.TidalVolume;
+    values[TotalLungVolume] = snapshot.TotalLungVolume;
+    values[OxygenSaturation] = snapshot.OxygenSaturation;
+    m_requests->Sample(snapshot.time_s, values + NumOutputs);
+    m_vitals.Push(snapshot.time_s, values);
+}
+
+void PulsePatient::publishVitals()
+{
+    // Never wait on the worker, if it has not published newer values we keep interpolating the ones we have
+    m_vitals.Update();
+    double time = m_vitals.GetLatestTime();
+    if (d_interpolate.getValue())
+        time = this->getContext()->getTime();
+    double* values = m_values.data();
+    double* errors = m_errors.data();
+    if (!m_vitals.Evaluate(time, d_maxExtrapolation.getValue(), values, errors))
+        return;
+
+    d_physiologyTime.setValue(m_vitals.GetLatestTime());
+    d_heartRate.setValue(values[HeartRate]);
+    d_systolicArterialPressure.setValue(values[SystolicArterialPressure]);
+    d_diastolicArterialPressure.setValue(values[DiastolicArterialPressure]);
+    d_meanArterialPressure.setValue(values[MeanArterialPressure]);
+    d_respirationRate.setValue(values[RespirationRate]);
+    d_tidalVolume.setValue(values[TidalVolume]);
+    d_totalLungVolume.setValue(values[TotalLungVolume]);
+    d_oxygenSaturation.setValue(values[OxygenSaturation]);
+    for (size_t i = 0; i < m_requestOutputs.size(); i++)
+        m_requestOutputs[i]->data->setValue(values[NumOutputs + i]);
+    // Written in place, the vector is only allocated when the number of outputs changes
+    helper::WriteOnlyAccessor<Data<sofa::helper::vector<double> > > interpolationError = d_interpolationError;
+    interpolationError.resize(m_errors.size());
+    std::copy(m_errors.begin(), m_errors.end(), interpolationError.begin());
+}
+
+SOFA_DECL_CLASS(PulsePatient)
+
+int PulsePatientClass = core::RegisterObject("A patient simulated by a Pulse physiology engine, stepped in the background of the animation loop")
+        .add< PulsePatient >()
+        ;
+
+} // namespace pulsephysiology
+} // namespace sofa
@@ -0,0 +1,150 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2018 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_PULSEPHYSIOLOGY_PULSEPATIENT_H
+#define SOFA_PULSEPHYSIOLOGY_PULSEPATIENT_H
+
+#include <PulsePhysiology.h>
+#include <PulsePhysiology/SampleBridge.h>
+#include <sofa/core/objectmodel/BaseObject.h>
+#include <sofa/core/objectmodel/Data.h>
+#include <sofa/helper/vector.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CCompoundUnit;
+class DataRequestSource;
+class PhysiologyEngine;
+class VitalsReader;
+
+namespace sofa
+{
+namespace pulsephysiology
+{
+
+/// A patient simulated by a Pulse physiology engine
+/// The engine is stepped on its own worker thread, in the background of the animation loop:
+/// at the beginning of each animation step the component asks the worker to bring the engine
+/// up to the new simulation time, and publishes the latest values computed by the worker.
+/// The animation loop never waits on the engine: the worker publishes the last few values it computed,
+/// and the outputs are interpolated between them at the animation time, or extrapolated a little if the worker is late.
+/// The engine time step (20ms) is much longer than the animation time step of mechanics or haptics (1ms),
+/// interpolating keeps breathing and pulsation smooth, interpolationError estimates the error of each output.
+/// Each data request registered in the data request manager of the engine, either listed in dataRequests
+/// or added through the engine, is published as a read-only output other components can link to,
+/// i.e. dataRequests="HeartRate(1/min) Brain-InFlow(mL/min)" adds the outputs HeartRate and Brain_InFlow.
+/// The requests are resolved once to the engine scalars they track, the worker samples them with the vitals.
+class SOFA_PULSEPHYSIOLOGY_API PulsePatient : public core::objectmodel::BaseObject
+{
+public:
+    SOFA_CLASS(PulsePatient, core::objectmodel::BaseObject);
+
+    Data<std::string> d_stateFile;
+    Data<std::string> d_logFile;
+    Data<bool> d_interpolate;
+    Data<double> d_maxExtrapolation;
+    Data<sofa::helper::vector<std::string> > d_dataRequests;
+
+    // Outputs
+    Data<double> d_physiologyTime;
+    Data<double> d_heartRate;
+    Data<double> d_systolicArterialPressure;
+    Data<double> d_diastolicArterialPressure;
+    Data<double> d_meanArterialPressure;
+    Data<double> d_respirationRate;
+    Data<double> d_tidalVolume;
+    Data<double> d_totalLungVolume;
+    Data<double> d_oxygenSaturation;
+    Data<sofa::helper::vector<double> > d_interpolationError;
+
+    void init() override;
+    void reset() override;
+    void cleanup() override;
+    void handleEvent(core::objectmodel::Event* event) override;
+
+    /// The engine, only to be used while the worker is stopped
+    PhysiologyEngine* getEngine() { return m_engine.get(); }
+    /// Publishes the data requests registered since init, call it after adding data requests to the engine
+    /// Requests added through the engine belong to it, a reset drops them with the engine
+    void updateDataRequests();
+
+protected:
+    PulsePatient();
+    ~PulsePatient() override;
+
+    /// Values computed on the worker thread, and published to the outputs on the animation thread
+    enum Output
+    {
+        HeartRate = 0,
+        SystolicArterialPressure,
+        DiastolicArterialPressure,
+        MeanArterialPressure,
+        RespirationRate,
+        TidalVolume,
+        TotalLungVolume,
+        OxygenSaturation,
+        NumOutputs
+    };
+
+    /// Output of a data request, the help string of a Data must outlive it
+    struct RequestOutput
+    {
+        std::string help;
+        std::unique_ptr<Data<double> > data;
+    };
+
+    void createDataRequests();
+    void createRequestOutputs();
+    void startWorker();
+    void stopWorker();
+    void work();
+    void pushVitals();
+    void publishVitals();
+
+    std::unique_ptr<PhysiologyEngine> m_engine;
+    std::unique_ptr<VitalsReader> m_vitalsReader;  // Only used by the worker once it is started
+    std::unique_ptr<DataRequestSource> m_requests; // Only used by the worker once it is started
+    std::vector<std::unique_ptr<CCompoundUnit> > m_requestUnits; // Units of the data requests of the scene
+    std::vector<std::unique_ptr<RequestOutput> > m_requestOutputs;
+    double m_dt;
+
+    std::thread m_worker;
+    std::atomic<bool> m_running;
+    std::atomic<double> m_targetTime;  // Simulation time the worker should bring the engine to
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+
+    SampleBridge<> m_vitals;           // The last values computed by the worker, the outputs then the data requests
+    std::vector<double> m_samples;     // Worker side values of the next sample
+    std::vector<double> m_values;      // Animation side values and errors, allocated once
+    std::vector<double> m_errors;
+};
+
+} // namespace pulsephysiology
+} // namespace sofa
+
+#endif // SOFA_PULSEPHYSIOLOGY_PULSEPATIENT_H
@@ -0,0 +1,108 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <thread>
+
+/// Statistics of an engine stepping in lockstep with the wall clock
+struct RealTimeStats
+{
+  size_t steps = 0;          // Number of steps computed
+  size_t deadlineMisses = 0; // Steps started more than a time step after their deadline
+  size_t droppedSteps = 0;   // Steps given up on, because catching up would have exceeded the burst limit
+  double worstLag_s = 0;     // Largest delay between a step deadline and the start of that step
+  double sumLag_s = 0;
+  double sumLag2_s = 0;
+
+  void Record(double lag_s, double dT_s)
+  {
+    steps++;
+    if (lag_s > dT_s)
+      deadlineMisses++;
+    if (lag_s > worstLag_s)
+      worstLag_s = lag_s;
+    sumLag_s += lag_s;
+    sumLag2_s += lag_s * lag_s;
+  }
+  double GetMeanLag_s() const { return steps == 0 ? 0 : sumLag_s / steps; }
+  /// Standard deviation of the step start times around their deadlines
+  double GetJitter_s() const
+  {
+    if (steps == 0)
+      return 0;
+    double mean = GetMeanLag_s();
+    return std::sqrt(std::fmax(0.0, sumLag2_s / steps - mean * mean));
+  }
+  void Write(std::ostream& out) const
+  {
+    out << "Real time steps : " << steps << ", deadline misses : " << deadlineMisses
+        << ", dropped steps : " << droppedSteps << ", mean lag : " << GetMeanLag_s() * 1e3
+        << "ms, jitter : " << GetJitter_s() * 1e3 << "ms, worst lag : " << worstLag_s * 1e3 << "ms";
+  }
+};
+
+/// Paces engine steps on the wall clock
+/// Step n is due at start + n * dT. Before each step the pacer sleeps until the step is due,
+/// if the engine fell behind (i.e. after a stall) steps are computed back to back to catch up,
+/// but never more than maxBurst steps: the schedule is moved forward past the others,
+/// which are counted as dropped.
+class RealTimePacer
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  RealTimePacer(double dT_s, size_t maxBurst = 10) : m_dT(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dT_s))),
+    m_dT_s(dT_s), m_MaxBurst(maxBurst), m_Started(false), m_Step(0) { }
+
+  /// Restart the schedule from now, i.e. after the simulation was paused
+  void Reset() { m_Started = false; }
+
+  /// Waits until the next step is due, call before computing each step
+  void WaitForNextStep()
+  {
+    Clock::time_point now = Clock::now();
+    if (!m_Started)
+    {
+      m_Started = true;
+      m_Start = now;
+      m_Step = 0;
+    }
+    Clock::time_point deadline = m_Start + GetStepsDuration(m_Step);
+    if (now < deadline)
+    {
+      std::this_thread::sleep_until(deadline);
+      now = Clock::now();
+    }
+    m_Stats.Record(std::chrono::duration<double>(now - deadline).count(), m_dT_s);
+    if (now - deadline > GetStepsDuration(m_MaxBurst))
+    {
+      // Too far behind to catch up, give up on the steps past the burst limit
+      size_t dropped = static_cast<size_t>((now - deadline) / m_dT) - m_MaxBurst;
+      m_Stats.droppedSteps += dropped;
+      m_Step += dropped;
+    }
+    m_Step++;
+  }
+
+  /// Time until the next step is due, negative if it is late
+  Clock::duration GetTimeToNextStep() const
+  {
+    return m_Started ? (m_Start + GetStepsDuration(m_Step)) - Clock::now() : Clock::duration::zero();
+  }
+
+  const RealTimeStats& GetStats() const { return m_Stats; }
+
+protected:
+  Clock::duration GetStepsDuration(size_t steps) const { return m_dT * static_cast<Clock::rep>(steps); }
+
+  Clock::duration m_dT;
+  double m_dT_s;
+  size_t m_MaxBurst;
+  bool m_Started;
+  size_t m_Step;
+  Clock::time_point m_Start;
+  RealTimeStats m_Stats;
+};
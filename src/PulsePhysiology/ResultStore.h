@@ -0,0 +1,193 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "ContentHash.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Identifies the build of the executable when it cannot be hashed, the build system can set its own
+// The scenarios are compiled in the translation unit that includes this file, so the time it was compiled changes with them
+#ifndef PULSE_PHYSIOLOGY_BUILD_ID
+#define PULSE_PHYSIOLOGY_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+/// The files read and written by a scenario run
+/// Like ScenarioMetrics, nothing is recorded unless a ScenarioFiles is installed on the running thread.
+/// Scenarios running engines on other threads install the same ScenarioFiles there, so it is thread safe.
+class ScenarioFiles
+{
+public:
+  /// The files of the scenario running on this thread, nullptr if they are not recorded
+  static ScenarioFiles*& Current()
+  {
+    static thread_local ScenarioFiles* current = nullptr;
+    return current;
+  }
+
+  /// Records a file read by the scenario, i.e. a state, on the current thread's scenario if any
+  static void AddInput(const std::string& file) { if (Current() != nullptr) Current()->Add(Current()->m_Inputs, file); }
+  /// Records a file written by the scenario, i.e. a log or results file, on the current thread's scenario if any
+  static void AddOutput(const std::string& file) { if (Current() != nullptr) Current()->Add(Current()->m_Outputs, file); }
+
+  std::vector<std::string> GetInputs() const { std::lock_guard<std::mutex> lock(m_Mutex); return m_Inputs; }
+  std::vector<std::string> GetOutputs() const { std::lock_guard<std::mutex> lock(m_Mutex); return m_Outputs; }
+
+private:
+  void Add(std::vector<std::string>& files, const std::string& file)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const std::string& f : files)
+      if (f == file)
+        return;
+    files.push_back(file);
+  }
+
+  mutable std::mutex m_Mutex;
+  std::vector<std::string> m_Inputs;
+  std::vector<std::string> m_Outputs;
+};
+
+/// On disk store of whole scenario runs
+/// A run is stored under a key computed before running it, from the scenario name, the executable
+/// (which contains the scenario definition, its actions and data requests), the Pulse version and the run options.
+/// Along with the files the run wrote, the store records the files it read and their content hash,
+/// so a stored run is only used if none of the states it started from changed since.
+/// Restoring a run copies its log and results files back, no engine is created.
+class ResultStore
+{
+public:
+  static ResultStore& GetInstance()
+  {
+    static ResultStore store("./results/");
+    return store;
+  }
+
+  /// Returns the key of a run of the given scenario, options describes everything else that changes its results
+  /// Where the running executable cannot be read, i.e. off Linux, the build id stands in for it, with a warning.
+  static std::string GetKey(const std::string& scenario, const std::string& options, const std::string& pulseVersion)
+  {
+    ContentHash hash;
+    hash.Add(scenario);
+    hash.Add(options);
+    hash.Add(pulseVersion);
+    if (!hash.AddFile("/proc/self/exe"))
+    {
+      static std::once_flag warned;
+      std::call_once(warned, []()
+      {
+        std::cout << "Unable to read the executable, results are memoized by build id (" << PULSE_PHYSIOLOGY_BUILD_ID
+                  << ") instead, rebuild after changing a scenario\n";
+      });
+      hash.Add(std::string(PULSE_PHYSIOLOGY_BUILD_ID));
+    }
+    return scenario + "@" + hash.ToString();
+  }
+
+  /// Copies the files of a stored run back in place, returns false if there is no usable run under that key
+  bool Restore(const std::string& key)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::string directory = m_Directory + key + "/";
+    std::ifstream manifest(directory + "manifest.txt");
+    if (!manifest)
+      return false;
+
+    std::vector<std::string> outputs;
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+      // input <hash> <file> or output <file>
+      if (line.compare(0, 6, "input ") == 0 && line.size() > 23)
+      {
+        if (line.substr(6, 16) != HashFile(line.substr(23)))
+          return false;
+      }
+      else if (line.compare(0, 7, "output ") == 0)
+        outputs.push_back(line.substr(7));
+    }
+    for (size_t i = 0; i < outputs.size(); i++)
+    {
+      if (!CopyFile(directory + std::to_string(i), outputs[i]))
+        return false;
+    }
+    return true;
+  }
+
+  /// Stores the files of a run under the given key
+  bool Store(const std::string& key, const ScenarioFiles& files)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::string directory = m_Directory + key + "/";
+    MakeDirectory(m_Directory);
+    MakeDirectory(directory);
+
+    std::stringstream manifest;
+    for (const std::string& input : files.GetInputs())
+      manifest << "input " << HashFile(input) << " " << input << "\n";
+    std::vector<std::string> outputs = files.GetOutputs();
+    for (size_t i = 0; i < outputs.size(); i++)
+    {
+      if (!CopyFile(outputs[i], directory + std::to_string(i)))
+        return false;
+      manifest << "output " << outputs[i] << "\n";
+    }
+    // The manifest is written last, and renamed into place, so a partially stored run is never restored
+    std::string manifestFile = directory + "manifest.txt";
+    {
+      std::ofstream out(manifestFile + ".tmp");
+      out << manifest.str();
+      if (!out)
+        return false;
+    }
+    return std::rename((manifestFile + ".tmp").c_str(), manifestFile.c_str()) == 0;
+  }
+
+private:
+  ResultStore(const std::string& directory) : m_Directory(directory) { }
+  ResultStore(const ResultStore&) = delete;
+  ResultStore& operator=(const ResultStore&) = delete;
+
+  /// Hash of the content of a file, a missing file hashes as the empty string
+  static std::string HashFile(const std::string& file)
+  {
+    ContentHash hash;
+    if (!hash.AddFile(file))
+      hash.Add(std::string());
+    return hash.ToString();
+  }
+
+  static bool CopyFile(const std::string& from, const std::string& to)
+  {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary);
+    if (!in || !out)
+      return false;
+    // Streaming an empty file sets the fail bit
+    if (in.peek() != std::ifstream::traits_type::eof())
+      out << in.rdbuf();
+    return static_cast<bool>(out);
+  }
+
+  static void MakeDirectory(const std::string& directory)
+  {
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+  }
+
+  std::string m_Directory;
+  std::mutex m_Mutex;
+};
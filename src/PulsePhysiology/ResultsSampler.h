@@ -0,0 +1,332 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "scenario/SEDataRequest.h"
+#include "scenario/SEDataRequestManager.h"
+#include "engine/SEEngineTracker.h"
+#include "AsyncResultsWriter.h"
+#include "ResultStore.h"
+#include "DataRequestSource.h"
+#include "VitalsRing.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Samples the data requests of an engine into the results file
+/// By default every data request is written at every time step, this class can decimate the output,
+/// either for all data requests or for specific ones, i.e. HeartRate at 1Hz and the Brain InFlow at every time step.
+/// A row is written whenever at least one channel is due, channels that are not due are left empty in that row.
+/// Rows are only copied on the simulation thread, formatting and writing the file is done by an AsyncResultsWriter.
+/// Channel sources are written after the data requests, at the sample period of the data requests without their own.
+/// Rows can also be streamed to a shared memory ring, for monitors following the run from another process.
+/// The rows of a segment of the run can be kept and saved, so a run resumed from a checkpoint replays them.
+class ResultsSampler
+{
+public:
+  enum class Format { CSV, Binary };
+
+  ResultsSampler(PhysiologyEngine& engine) : m_Engine(engine), m_SamplePeriod_s(GetDefaultSamplePeriod()), m_IsSetup(false),
+    m_IsConnected(false), m_RecordSegment(false), m_Format(GetDefaultFormat()), m_SourceStepsPerSample(1), m_Writer(CreateFormat(m_Format))
+  {
+    m_dT_s = m_Engine.GetTimeStep(TimeUnit::s);
+  }
+  ~ResultsSampler() { Close(); }
+
+  /// The results format used by new samplers, binary results are written to a .bin file instead of the .csv file
+  static Format& GetDefaultFormat()
+  {
+    static Format format = Format::CSV;
+    return format;
+  }
+
+  /// The sample period used by new samplers that are not given one, 0 samples every time step
+  static double& GetDefaultSamplePeriod()
+  {
+    static double period_s = 0;
+    return period_s;
+  }
+
+  /// Whether new samplers also publish their rows to a shared memory ring named after the results file
+  static bool& GetDefaultSharedMemory()
+  {
+    static bool sharedMemory = false;
+    return sharedMemory;
+  }
+
+  /// Sample period of every data request without its own period, 0 samples every time step
+  void SetSamplePeriod(double period_s) { m_SamplePeriod_s = period_s; }
+  /// Sample period of a specific data request, 0 samples it every time step
+  void SetSamplePeriod(const SEDataRequest& dr, double period_s) { m_ChannelPeriods_s[&dr] = period_s; }
+
+  /// Adds channels sampled from the engine by the given source, before the first sample
+  void AddChannels(std::unique_ptr<ChannelSource> source) { m_Sources.push_back(std::move(source)); }
+
+  /// Call after loading a state into the engine, the channels are connected to the new engine scalars before the next sample
+  /// The results file, the ring and the columns are kept.
+  void Reset() { m_IsConnected = false; }
+
+  /// Sets up the channels and opens the results file, if not done by a sample yet
+  void Prepare()
+  {
+    if (!m_IsSetup)
+      Setup();
+  }
+
+  /// Identifies the columns and sample periods of the results, segments are only replayed into results with the same layout
+  std::string GetLayout() const
+  {
+    ContentHash hash;
+    for (const std::string& name : m_ColumnNames)
+      hash.Add(name);
+    for (const Channel& c : m_Channels)
+    {
+      uint64_t steps = c.stepsPerSample;
+      hash.Add(&steps, sizeof(steps));
+    }
+    uint64_t steps = m_SourceStepsPerSample;
+    hash.Add(&steps, sizeof(steps));
+    return hash.ToString();
+  }
+
+  /// Keeps a copy of the rows written from now on, dropping the ones kept so far
+  void StartSegment()
+  {
+    m_RecordSegment = true;
+    m_Segment.clear();
+  }
+
+  /// Saves the rows kept since StartSegment to a binary columnar file
+  bool SaveSegment(const std::string& file) const
+  {
+    // Save to a temporary file first, so another process never reads a partially written segment
+    std::string tmpFile = file + ".tmp";
+    bool saved;
+    {
+      std::ofstream out(tmpFile, std::ios::binary);
+      ColumnarResults::WriteHeader(out, m_ColumnNames);
+      ColumnarResults::WriteBlock(out, m_Segment.data(), m_Segment.size() / m_Row.size(), m_Row.size());
+      saved = static_cast<bool>(out);
+    }
+    if (!saved || std::rename(tmpFile.c_str(), file.c_str()) != 0)
+    {
+      std::remove(tmpFile.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  /// Reads the rows of a segment saved by SaveSegment, returns false if they are not rows of these results
+  bool ReadSegment(const std::string& file, std::vector<double>& rows) const
+  {
+    ColumnarResults::Reader reader;
+    if (!reader.Open(file) || reader.GetColumnNames() != m_ColumnNames)
+      return false;
+    size_t numColumns = m_ColumnNames.size();
+    rows.resize(reader.GetNumRows() * numColumns);
+    double* row = rows.data();
+    for (size_t b = 0; b < reader.GetNumBlocks(); b++)
+    {
+      for (size_t r = 0; r < reader.GetBlockNumRows(b); r++, row += numColumns)
+        for (size_t c = 0; c < numColumns; c++)
+          row[c] = reader.GetBlockColumn(b, c)[r];
+    }
+    return true;
+  }
+
+  /// Writes rows read by ReadSegment as if they were sampled, i.e. the rows of time steps resumed from a checkpoint
+  void Replay(const std::vector<double>& rows)
+  {
+    for (size_t i = 0; i + m_Row.size() <= rows.size(); i += m_Row.size())
+    {
+      const double* row = &rows[i];
+      for (size_t c = 0; c < m_Channels.size(); c++)
+      {
+        if (!std::isnan(row[c + 1]))
+          m_Channels[c].value = row[c + 1];
+      }
+      m_Writer.Append(row);
+      if (m_Ring.IsOpen())
+        m_Ring.Publish(row);
+      if (m_RecordSegment)
+        m_Segment.insert(m_Segment.end(), row, row + m_Row.size());
+    }
+  }
+
+  /// Writes the values of the due channels, step is the number of time steps computed so far
+  void Sample(size_t step, double time_s)
+  {
+    if (!m_IsSetup)
+      Setup();
+    else if (!m_IsConnected)
+      Connect();
+
+    bool due = false;
+    for (Channel& c : m_Channels)
+    {
+      c.due = (step % c.stepsPerSample) == 0;
+      due |= c.due;
+    }
+    bool sourcesDue = !m_Sources.empty() && (step % m_SourceStepsPerSample) == 0;
+    if (!due && !sourcesDue)
+      return;
+
+    if (due)
+      m_Engine.GetEngineTracker()->PullData();
+    m_Row[0] = time_s;
+    for (size_t i = 0; i < m_Channels.size(); i++)
+    {
+      Channel& c = m_Channels[i];
+      if (c.due)
+      {
+        c.value = m_Engine.GetEngineTracker()->GetValue(*c.request);
+        m_Row[i + 1] = c.value;
+      }
+      else
+        m_Row[i + 1] = std::numeric_limits<double>::quiet_NaN();
+    }
+    double* values = m_Row.data() + 1 + m_Channels.size();
+    for (std::unique_ptr<ChannelSource>& source : m_Sources)
+    {
+      if (sourcesDue)
+        source->Sample(time_s, values);
+      else
+        std::fill(values, values + source->GetNumChannels(), std::numeric_limits<double>::quiet_NaN());
+      values += source->GetNumChannels();
+    }
+    m_Writer.Append(m_Row.data());
+    if (m_Ring.IsOpen())
+      m_Ring.Publish(m_Row.data());
+    if (m_RecordSegment && m_Writer.IsOpen())
+      m_Segment.insert(m_Segment.end(), m_Row.begin(), m_Row.end());
+  }
+
+  /// Writes the remaining rows and closes the results file, and the ring
+  /// The times the simulation waited on the file are reported in the log, the output is then too large to keep up with
+  void Close()
+  {
+    bool open = m_Writer.IsOpen();
+    m_Writer.Close();
+    m_Ring.Close();
+    if (open && m_Writer.GetNumStalls() > 0)
+      m_Engine.GetLogger()->Warning("The simulation waited " + std::to_string(m_Writer.GetNumStalls()) +
+                                    " times on the results file " + m_Filename + ", consider a larger sample period");
+  }
+
+  /// The results file, empty until the first sample or if the engine has no results file
+  const std::string& GetFilename() const { return m_Filename; }
+
+  size_t GetNumChannels() const { return m_Channels.size(); }
+  const std::string& GetChannelName(size_t channel) const { return m_Channels[channel].name; }
+  /// The last sampled value of the channel, NaN if it has not been sampled yet
+  double GetValue(size_t channel) const { return m_Channels[channel].value; }
+
+protected:
+  struct Channel
+  {
+    const SEDataRequest* request;
+    std::string name;
+    size_t stepsPerSample;
+    bool due;
+    double value;
+  };
+
+  static std::unique_ptr<ResultsFormat> CreateFormat(Format format)
+  {
+    if (format == Format::Binary)
+      return std::unique_ptr<ResultsFormat>(new BinaryResultsFormat());
+    return std::unique_ptr<ResultsFormat>(new CsvResultsFormat());
+  }
+
+  size_t GetStepsPerSample(double period_s) const
+  {
+    long steps = std::lround(period_s / m_dT_s);
+    return steps < 1 ? 1 : static_cast<size_t>(steps);
+  }
+
+  // Connects the data requests and channel sources to the scalars of the engine
+  void Connect()
+  {
+    m_IsConnected = true;
+    m_Engine.GetEngineTracker()->SetupRequests();
+    for (std::unique_ptr<ChannelSource>& source : m_Sources)
+      source->Setup(m_Engine);
+  }
+
+  void Setup()
+  {
+    m_IsSetup = true;
+    m_IsConnected = true;
+    SEEngineTracker& tracker = *m_Engine.GetEngineTracker();
+    tracker.SetupRequests();
+    for (SEDataRequest* dr : tracker.GetDataRequestManager().GetDataRequests())
+    {
+      Channel c;
+      c.request = dr;
+      c.name = ::GetChannelName(*dr);
+      auto period = m_ChannelPeriods_s.find(dr);
+      c.stepsPerSample = GetStepsPerSample(period == m_ChannelPeriods_s.end() ? m_SamplePeriod_s : period->second);
+      c.due = false;
+      c.value = std::numeric_limits<double>::quiet_NaN();
+      m_Channels.push_back(c);
+    }
+
+    size_t numValues = m_Channels.size();
+    m_SourceStepsPerSample = GetStepsPerSample(m_SamplePeriod_s);
+    for (std::unique_ptr<ChannelSource>& source : m_Sources)
+    {
+      source->Setup(m_Engine);
+      numValues += source->GetNumChannels();
+    }
+    m_Row.resize(numValues + 1);
+    std::string filename = tracker.GetDataRequestManager().GetResultsFilename();
+    if (filename.empty())
+      return;
+    std::vector<std::string> names;
+    for (const Channel& c : m_Channels)
+      names.push_back(c.name);
+    for (const std::unique_ptr<ChannelSource>& source : m_Sources)
+      for (size_t i = 0; i < source->GetNumChannels(); i++)
+        names.push_back(source->GetChannelName(i));
+    m_ColumnNames.assign(1, "Time(s)");
+    m_ColumnNames.insert(m_ColumnNames.end(), names.begin(), names.end());
+    if (GetDefaultSharedMemory())
+    {
+      if (!m_Ring.Open(VitalsRing::GetName(filename), m_ColumnNames))
+        m_Engine.GetLogger()->Error("Unable to create the shared memory ring " + VitalsRing::GetName(filename));
+    }
+    if (m_Format == Format::Binary)
+      filename = filename.substr(0, filename.find_last_of('.')) + ".bin";
+    ScenarioFiles::AddOutput(filename);
+    if (!m_Writer.Open(filename, names))
+      m_Engine.GetLogger()->Error("Unable to open results file " + filename);
+    else
+      m_Filename = filename;
+  }
+
+  PhysiologyEngine& m_Engine;
+  double m_dT_s;
+  double m_SamplePeriod_s;
+  bool m_IsSetup;
+  bool m_IsConnected;  // False once a state is loaded, until the channels are connected again
+  Format m_Format;
+  std::map<const SEDataRequest*, double> m_ChannelPeriods_s;
+  std::vector<Channel> m_Channels;
+  std::vector<std::unique_ptr<ChannelSource>> m_Sources;
+  size_t m_SourceStepsPerSample;
+  std::vector<double> m_Row;
+  std::vector<std::string> m_ColumnNames;  // Including the time, empty if the engine has no results file
+  bool m_RecordSegment;
+  std::vector<double> m_Segment;           // The rows written since StartSegment
+  std::string m_Filename;
+  AsyncResultsWriter m_Writer;
+  VitalsRing::Writer m_Ring;
+};
@@ -0,0 +1,149 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/// Hands the latest engine samples from the engine thread to a faster thread, i.e. SOFA mechanics at 1kHz,
+/// which reads the channels at any time in between samples.
+/// The engine thread pushes a sample after each time step, the reader gets the last Depth samples through
+/// a lock-free triple buffer: neither side ever waits on the other, the reader keeps using the samples
+/// it has until newer ones are published.
+/// Within the samples, values are linearly interpolated; past the last sample they are linearly extrapolated,
+/// for at most the given horizon. The error of each value is estimated as the difference with the quadratic
+/// through the neighbouring sample, it is 0 until 3 samples are available.
+/// The buffers are allocated when the number of channels is set, pushing and reading never allocate.
+template<size_t Depth = 4>
+class SampleBridge
+{
+  static_assert(Depth >= 3, "Estimating the interpolation error takes 3 samples");
+public:
+  struct History
+  {
+    size_t count;                             // Number of samples, oldest first
+    double time[Depth];
+    std::vector<double> values;               // The channels of each sample, one sample after the other
+  };
+
+  SampleBridge(size_t numChannels = 0) : m_Middle(1), m_Back(2), m_Front(0) { Reset(numChannels); }
+
+  /// Drops every sample, only while neither thread uses the bridge
+  void Reset(size_t numChannels)
+  {
+    m_NumChannels = numChannels;
+    m_Local.count = 0;
+    m_Local.values.assign(Depth * numChannels, 0.0);
+    for (History& h : m_Slots)
+    {
+      h.count = 0;
+      h.values.assign(Depth * numChannels, 0.0);
+    }
+    m_Middle.store(1);
+    m_Back = 2;
+    m_Front = 0;
+  }
+
+  size_t GetNumChannels() const { return m_NumChannels; }
+
+  /// Engine side, publishes a sample, times must increase
+  void Push(double time, const double* values)
+  {
+    if (m_Local.count == Depth)
+    {
+      std::copy(m_Local.time + 1, m_Local.time + Depth, m_Local.time);
+      std::copy(m_Local.values.begin() + m_NumChannels, m_Local.values.end(), m_Local.values.begin());
+      m_Local.count--;
+    }
+    m_Local.time[m_Local.count] = time;
+    std::copy(values, values + m_NumChannels, m_Local.values.begin() + m_Local.count * m_NumChannels);
+    m_Local.count++;
+
+    // The vectors have the same size, copying does not allocate
+    History& back = m_Slots[m_Back];
+    back.count = m_Local.count;
+    std::copy(m_Local.time, m_Local.time + Depth, back.time);
+    std::copy(m_Local.values.begin(), m_Local.values.end(), back.values.begin());
+    m_Back = m_Middle.exchange(m_Back | Fresh, std::memory_order_acq_rel) & Index;
+  }
+
+  /// Reader side, takes the latest samples published, returns false if there are none since the last update
+  bool Update()
+  {
+    if ((m_Middle.load(std::memory_order_relaxed) & Fresh) == 0)
+      return false;
+    m_Front = m_Middle.exchange(m_Front, std::memory_order_acq_rel) & Index;
+    return true;
+  }
+
+  /// Reader side, the samples taken by the last update
+  const History& GetHistory() const { return m_Slots[m_Front]; }
+  /// Time of the latest sample taken by the last update, NaN if there is none
+  double GetLatestTime() const
+  {
+    const History& h = GetHistory();
+    return h.count == 0 ? NAN : h.time[h.count - 1];
+  }
+
+  /// Reader side, the value of each channel at the given time, and the estimated error of each value if errors is not nullptr
+  /// Returns false if there is no sample yet. Before the first sample, the first sample is used.
+  bool Evaluate(double time, double maxExtrapolation, double* values, double* errors = nullptr) const
+  {
+    const History& h = GetHistory();
+    if (h.count == 0)
+      return false;
+    if (h.count == 1 || time <= h.time[0])
+    {
+      std::copy(h.values.begin(), h.values.begin() + m_NumChannels, values);
+      if (errors != nullptr)
+        std::fill(errors, errors + m_NumChannels, 0.0);
+      return true;
+    }
+
+    // The segment of the time, or the last one when extrapolating, and the third sample of the quadratic
+    size_t last = h.count - 1;
+    size_t i = 0;
+    while (i + 1 < last && h.time[i + 1] <= time)
+      i++;
+    size_t j = i + 1;
+    time = std::min(time, h.time[last] + maxExtrapolation);
+    size_t k = i > 0 ? i - 1 : j + 1;
+
+    double ti = h.time[i], tj = h.time[j];
+    double u = (time - ti) / (tj - ti);
+    const double* vi = &h.values[i * m_NumChannels];
+    const double* vj = &h.values[j * m_NumChannels];
+    for (size_t c = 0; c < m_NumChannels; c++)
+      values[c] = vi[c] + (vj[c] - vi[c]) * u;
+    if (errors == nullptr)
+      return true;
+    if (k > last)
+    {
+      std::fill(errors, errors + m_NumChannels, 0.0);
+      return true;
+    }
+    // Lagrange basis of the quadratic through i, j and k
+    double tk = h.time[k];
+    double li = (time - tj) * (time - tk) / ((ti - tj) * (ti - tk));
+    double lj = (time - ti) * (time - tk) / ((tj - ti) * (tj - tk));
+    double lk = (time - ti) * (time - tj) / ((tk - ti) * (tk - tj));
+    const double* vk = &h.values[k * m_NumChannels];
+    for (size_t c = 0; c < m_NumChannels; c++)
+      errors[c] = std::abs(li * vi[c] + lj * vj[c] + lk * vk[c] - values[c]);
+    return true;
+  }
+
+private:
+  static const unsigned Index = 3;
+  static const unsigned Fresh = 4;
+
+  size_t m_NumChannels;
+  History m_Slots[3];
+  History m_Local;                    // Engine side copy of the samples
+  alignas(64) std::atomic<unsigned> m_Middle; // Slot last published, with the Fresh bit until the reader takes it
+  alignas(64) unsigned m_Back;        // Engine side slot
+  alignas(64) unsigned m_Front;       // Reader side slot
+};
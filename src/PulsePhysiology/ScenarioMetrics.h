@@ -0,0 +1,78 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+/// Timing measurements of one scenario run
+/// Measurements are only taken while a ScenarioMetrics is installed on the running thread,
+/// so regular runs do not pay for them.
+struct ScenarioMetrics
+{
+  typedef std::chrono::steady_clock Clock;
+
+  double engineCreation_s = 0;  // Time spent in CreatePulseEngine
+  double stateLoad_s = 0;       // Time spent loading states or initializing the engine
+  double stepping_s = 0;        // Time spent advancing the engine and sampling its results
+  double simTime_s = 0;         // Simulated time
+  std::vector<double> stepLatencies_s;
+
+  /// The metrics of the scenario running on this thread, nullptr if none are collected
+  static ScenarioMetrics*& Current()
+  {
+    static thread_local ScenarioMetrics* current = nullptr;
+    return current;
+  }
+
+  /// Adds the measurements of another run, i.e. of an engine forked on another thread
+  void Merge(const ScenarioMetrics& other)
+  {
+    engineCreation_s += other.engineCreation_s;
+    stateLoad_s += other.stateLoad_s;
+    stepping_s += other.stepping_s;
+    simTime_s += other.simTime_s;
+    stepLatencies_s.insert(stepLatencies_s.end(), other.stepLatencies_s.begin(), other.stepLatencies_s.end());
+  }
+
+  static double Seconds(Clock::time_point start, Clock::time_point end)
+  {
+    return std::chrono::duration<double>(end - start).count();
+  }
+
+  size_t GetNumSteps() const { return stepLatencies_s.size(); }
+  double GetStepsPerSecond() const { return stepping_s > 0 ? GetNumSteps() / stepping_s : 0; }
+  double GetSimToWallRatio() const { return stepping_s > 0 ? simTime_s / stepping_s : 0; }
+  /// Returns the given percentile (0 to 1) of the per step latency
+  double GetStepLatencyPercentile(double p) const
+  {
+    if (stepLatencies_s.empty())
+      return 0;
+    std::vector<double> sorted(stepLatencies_s);
+    size_t n = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+    std::nth_element(sorted.begin(), sorted.begin() + n, sorted.end());
+    return sorted[n];
+  }
+};
+
+/// Adds the time spent in its scope to a ScenarioMetrics member, if metrics are being collected
+class ScopedMetric
+{
+public:
+  ScopedMetric(double ScenarioMetrics::*member) : m_Metrics(ScenarioMetrics::Current()), m_Member(member)
+  {
+    if (m_Metrics != nullptr)
+      m_Start = ScenarioMetrics::Clock::now();
+  }
+  ~ScopedMetric()
+  {
+    if (m_Metrics != nullptr)
+      m_Metrics->*m_Member += ScenarioMetrics::Seconds(m_Start, ScenarioMetrics::Clock::now());
+  }
+
+private:
+  ScenarioMetrics* m_Metrics;
+  double ScenarioMetrics::*m_Member;
+  ScenarioMetrics::Clock::time_point m_Start;
+};
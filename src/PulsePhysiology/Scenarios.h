@@ -0,0 +1,65 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+// Each how-to scenario lives in its own file
+#include "AirwayObstruction.cpp"
+#include "AnesthesiaMachine.cpp"
+#include "Asthma.cpp"
+#include "BolusDrug.cpp"
+#include "BrainInjury.cpp"
+#include "COPD.cpp"
+#include "CPR.cpp"
+#include "CPRManikin.cpp"
+#include "CPRSweep.cpp"
+#include "LobarPneumonia.cpp"
+#include "MassCasualty.cpp"
+#include "PulmonaryFunctionTest.cpp"
+#include "Smoke.cpp"
+#include "TensionPneumothorax.cpp"
+#include <string.h>
+
+// Engine stabilization (InitializeEngine with conditions) is much more expensive than
+// loading a state, this is the amount of simulated time we consider it to be worth
+#define SCENARIO_STABILIZATION_COST_S 600.0
+
+/// Describes a how-to scenario that can be run from the command line
+struct ScenarioInfo
+{
+  const char* name;       // Name used on the command line
+  void (*run)();          // The how-to function
+  double expectedCost_s;  // Relative cost of the scenario, in simulated seconds, used to schedule long runs first
+  void (*stabilize)();    // Fills the stabilized state library with the conditions of the scenario, nullptr if it has none
+  bool realTime;          // Runs in lockstep with the wall clock, so it is run alone once the other scenarios are done
+};
+
+static const ScenarioInfo Scenarios[] =
+{
+  { "AirwayObstruction",     HowToAirwayObstruction,     440, nullptr, false },
+  { "AnesthesiaMachine",     HowToAnesthesiaMachine,     530, nullptr, false },
+  { "Asthma",                HowToAsthmaAttack,          800, nullptr, false },
+  { "BolusDrug",             HowToBolusDrug,             250, nullptr, false },
+  { "BrainInjury",           HowToBrainInjury,           510, nullptr, false },
+  { "COPD",                  HowToCOPD,                  500 + SCENARIO_STABILIZATION_COST_S, StabilizeCOPD, false },
+  { "CPR",                   HowToCPR,                   180, nullptr, false },
+  { "CPRManikin",            HowToCPRManikin,            90, nullptr, true },
+  { "CPRSweep",              HowToCPRSweep,              60 + 30 * 120, nullptr, false },
+  { "LobarPneumonia",        HowToLobarPneumonia,        500 + SCENARIO_STABILIZATION_COST_S, StabilizeLobarPneumonia, false },
+  { "MassCasualty",          HowToMassCasualty,          60 * 200, nullptr, true },
+  { "PulmonaryFunctionTest", HowToPulmonaryFunctionTest, 5, nullptr, false },
+  { "Smoke",                 HowToSmoke,                 35, nullptr, false },
+  { "TensionPneumothorax",   HowToTensionPneumothorax,   570, nullptr, false },
+};
+
+static const size_t NumScenarios = sizeof(Scenarios) / sizeof(Scenarios[0]);
+
+/// Returns the scenario registered under the given name, or nullptr if there is none
+inline const ScenarioInfo* FindScenario(const char* name)
+{
+  for (size_t i = 0; i < NumScenarios; i++)
+  {
+    if (strcmp(Scenarios[i].name, name) == 0)
+      return &Scenarios[i];
+  }
+  return nullptr;
+}
@@ -46,8 +46,8 @@
 void HowToSmoke()
 {
   // Create the engine and load the patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("Smoke.log");
-  pe->GetLogger()->Info("HowToSmoke");
+  PooledEngine pe = CreateScenarioEngine("Smoke.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToSmoke");
   /*
   // Smoke is made up of many things.
   // You will need to add 2 things to the environement to effectively model a smokey environment
@@ -67,7 +67,7 @@ void HowToSmoke()
   }
   */
   
-  if (!pe->LoadStateFile("./states/StandardMale@0s.pba"))
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
   {
     pe->GetLogger()->Error("Could not load state, check the error");
     return;
@@ -105,24 +105,24 @@ void HowToSmoke()
   // Advance some time to get some resting data
   tracker.AdvanceModelTime(5);
 
-  pe->GetLogger()->Info("The patient is nice and healthy");
-  pe->GetLogger()->Info(std::stringstream() << "Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "CarbonDioxide Saturation : " << pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Carbon Monoxide Saturation : " << pe->GetBloodChemistrySystem()->GetCarbonMonoxideSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Pulse Oximetry : " << pe->GetBloodChemistrySystem()->GetPulseOximetry());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is nice and healthy");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "CarbonDioxide Saturation : {}", pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carbon Monoxide Saturation : {}", pe->GetBloodChemistrySystem()->GetCarbonMonoxideSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Pulse Oximetry : {}", pe->GetBloodChemistrySystem()->GetPulseOximetry());
   // There are liquid compartments for each of the gas pulmonary compartments, these track the trasportation of liquid and solid substances through the pulmonary tract, and their deposition
   // Currently, since we have not changed the environment there is no Particulate or CO in the system, so the GetSubstanceQuantity call will return nullptr, so keep this commented
-  //pe->GetLogger()->Info(std::stringstream() << "Particulate Deposition : " << pe->GetCompartments().GetLiquidCompartment(pulse::PulmonaryCompartment::RightAlveoli)->GetSubstanceQuantity(*Particulate)->GetMassDeposited(MassUnit::ug) << MassUnit::ug);
-
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() <<"Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Skin Temperature : " << pe->GetEnergySystem()->GetSkinTemperature(TemperatureUnit::C) << TemperatureUnit::C);
-  pe->GetLogger()->Info(std::stringstream() <<"Core Temperature : " << pe->GetEnergySystem()->GetCoreTemperature(TemperatureUnit::C) << TemperatureUnit::C);
-  pe->GetLogger()->Info(std::stringstream() <<"Total Metabolic Rate : " << pe->GetEnergySystem()->GetTotalMetabolicRate(PowerUnit::W) << PowerUnit::W);
-  pe->GetLogger()->Info(std::stringstream() <<"Systemic Vascular Resistance : " << pe->GetCardiovascularSystem()->GetSystemicVascularResistance(FlowResistanceUnit::mmHg_s_Per_mL) << FlowResistanceUnit::mmHg_s_Per_mL);;
+  //SCENARIO_LOG_INFO(pe->GetLogger(), "Particulate Deposition : {}{}", pe->GetCompartments().GetLiquidCompartment(pulse::PulmonaryCompartment::RightAlveoli)->GetSubstanceQuantity(*Particulate)->GetMassDeposited(MassUnit::ug), MassUnit::ug);
+
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cardiac Output : {}{}", pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Skin Temperature : {}{}", pe->GetEnergySystem()->GetSkinTemperature(TemperatureUnit::C), TemperatureUnit::C);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Core Temperature : {}{}", pe->GetEnergySystem()->GetCoreTemperature(TemperatureUnit::C), TemperatureUnit::C);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Total Metabolic Rate : {}{}", pe->GetEnergySystem()->GetTotalMetabolicRate(PowerUnit::W), PowerUnit::W);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systemic Vascular Resistance : {}{}", pe->GetCardiovascularSystem()->GetSystemicVascularResistance(FlowResistanceUnit::mmHg_s_Per_mL), FlowResistanceUnit::mmHg_s_Per_mL);;
 
   // Here we will put this healty patient into a smokey environment.
   SEChangeEnvironmentConditions envChange(pe->GetSubstanceManager());
@@ -133,27 +133,28 @@ void HowToSmoke()
   envChange.GetConditions().GetAmbientGas(*CO).GetFractionAmount().SetValue(2.0E-5);
   // Concentrations are independent and do not need to add up to 1.0
   envChange.GetConditions().GetAmbientAerosol(*Particulate).GetConcentration().SetValue(2.9, MassPerVolumeUnit::mg_Per_m3);
-  pe->ProcessAction(envChange);
+  tracker.ProcessAction(envChange);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
   tracker.AdvanceModelTime(30);
 
-  pe->GetLogger()->Info(std::stringstream() << "Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "CarbonDioxide Saturation : " << pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Carbon Monoxide Saturation : " << pe->GetBloodChemistrySystem()->GetCarbonMonoxideSaturation());
-  pe->GetLogger()->Info(std::stringstream() << "Pulse Oximetry : " << pe->GetBloodChemistrySystem()->GetPulseOximetry());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Oxygen Saturation : {}", pe->GetBloodChemistrySystem()->GetOxygenSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "CarbonDioxide Saturation : {}", pe->GetBloodChemistrySystem()->GetCarbonDioxideSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Carbon Monoxide Saturation : {}", pe->GetBloodChemistrySystem()->GetCarbonMonoxideSaturation());
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Pulse Oximetry : {}", pe->GetBloodChemistrySystem()->GetPulseOximetry());
   // There are liquid compartments for each of the gas pulmonary compartments, these track the trasportation of liquid and solid substances through the pulmonary tract, and their deposition
-  pe->GetLogger()->Info(std::stringstream() << "Particulate Deposition : " << pe->GetCompartments().GetLiquidCompartment(pulse::PulmonaryCompartment::RightAlveoli)->GetSubstanceQuantity(*Particulate)->GetMassDeposited(MassUnit::ug) << MassUnit::ug);
-
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info(std::stringstream() <<"Mean Arterial Pressure : " << pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Skin Temperature : " << pe->GetEnergySystem()->GetSkinTemperature(TemperatureUnit::C) << TemperatureUnit::C);
-  pe->GetLogger()->Info(std::stringstream() <<"Core Temperature : " << pe->GetEnergySystem()->GetCoreTemperature(TemperatureUnit::C) << TemperatureUnit::C);
-  pe->GetLogger()->Info(std::stringstream() <<"Total Metabolic Rate : " << pe->GetEnergySystem()->GetTotalMetabolicRate(PowerUnit::W) << PowerUnit::W);
-  pe->GetLogger()->Info(std::stringstream() <<"Systemic Vascular Resistance : " << pe->GetCardiovascularSystem()->GetSystemicVascularResistance(FlowResistanceUnit::mmHg_s_Per_mL) << FlowResistanceUnit::mmHg_s_Per_mL);;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Particulate Deposition : {}{}", pe->GetCompartments().GetLiquidCompartment(pulse::PulmonaryCompartment::RightAlveoli)->GetSubstanceQuantity(*Particulate)->GetMassDeposited(MassUnit::ug), MassUnit::ug);
+
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Cardiac Output : {}{}", pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min), VolumePerTimeUnit::mL_Per_min);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Mean Arterial Pressure : {}{}", pe->GetCardiovascularSystem()->GetMeanArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Diastolic Pressure : {}{}", pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg), PressureUnit::mmHg);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Heart Rate : {}bpm", pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min));
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Skin Temperature : {}{}", pe->GetEnergySystem()->GetSkinTemperature(TemperatureUnit::C), TemperatureUnit::C);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Core Temperature : {}{}", pe->GetEnergySystem()->GetCoreTemperature(TemperatureUnit::C), TemperatureUnit::C);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Total Metabolic Rate : {}{}", pe->GetEnergySystem()->GetTotalMetabolicRate(PowerUnit::W), PowerUnit::W);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Systemic Vascular Resistance : {}{}", pe->GetCardiovascularSystem()->GetSystemicVascularResistance(FlowResistanceUnit::mmHg_s_Per_mL), FlowResistanceUnit::mmHg_s_Per_mL);;
 
   // Here is the amount of particulate 
 
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
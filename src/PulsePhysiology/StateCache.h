@@ -0,0 +1,93 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "ScenarioMetrics.h"
+#include "ResultStore.h"
+#include <google/protobuf/message.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/// Process wide cache of patient states
+/// The first engine to ask for a state file reads and parses it from disk,
+/// the parsed state is then kept in memory and every following engine is loaded from it,
+/// so starting an engine costs a copy of the state instead of file I/O and parsing.
+/// This class is thread safe, engines on different threads can load the same state at once.
+class PatientStateCache
+{
+public:
+  static PatientStateCache& GetInstance()
+  {
+    static PatientStateCache cache;
+    return cache;
+  }
+
+  /// Loads the given state file into the engine, reading the file only the first time it is asked for
+  bool LoadState(PhysiologyEngine& pe, const std::string& file)
+  {
+    std::shared_ptr<Entry> entry = GetEntry(file);
+    // Hold the entry lock while loading it, so other engines wait for the state rather than parsing it too
+    std::unique_lock<std::mutex> lock(entry->mutex);
+    if (entry->state == nullptr)
+    {
+      if (!pe.LoadStateFile(file))
+        return false;
+      entry->state = pe.SaveState();
+      return entry->state != nullptr;
+    }
+    // The state is never modified once cached, so it can be shared without holding the lock
+    std::shared_ptr<const google::protobuf::Message> state = entry->state;
+    lock.unlock();
+    return pe.LoadState(*state);
+  }
+
+  /// Returns the in memory image of a state, or nullptr if that state has not been loaded yet
+  std::shared_ptr<const google::protobuf::Message> GetState(const std::string& file)
+  {
+    std::shared_ptr<Entry> entry = GetEntry(file);
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    return entry->state;
+  }
+
+  /// Frees all cached states
+  void Clear()
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.clear();
+  }
+
+private:
+  PatientStateCache() { }
+  PatientStateCache(const PatientStateCache&) = delete;
+  PatientStateCache& operator=(const PatientStateCache&) = delete;
+
+  struct Entry
+  {
+    std::mutex mutex;
+    std::shared_ptr<const google::protobuf::Message> state;
+  };
+
+  std::shared_ptr<Entry> GetEntry(const std::string& file)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::shared_ptr<Entry>& entry = m_Entries[file];
+    if (entry == nullptr)
+      entry = std::make_shared<Entry>();
+    return entry;
+  }
+
+  std::mutex m_Mutex;
+  std::map<std::string, std::shared_ptr<Entry>> m_Entries;
+};
+
+/// Loads a state file into the engine through the process wide state cache
+inline bool LoadCachedState(PhysiologyEngine& pe, const std::string& file)
+{
+  ScopedMetric metric(&ScenarioMetrics::stateLoad_s);
+  ScenarioFiles::AddInput(file);
+  return PatientStateCache::GetInstance().LoadState(pe, file);
+}
@@ -0,0 +1,187 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "engine/SEEventHandler.h"
+#include "TypedSampler.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// A condition that ends the advances of a HowToTracker early, once the outcome of the run is decided
+class StopCondition
+{
+public:
+  virtual ~StopCondition() { }
+  /// Called after each time step, returns true once the run can stop
+  virtual bool IsMet(double time_s) = 0;
+  /// Why the run stopped, for the log
+  virtual std::string GetReason() const = 0;
+  /// Called after a state is loaded into the engine, conditions reading engine scalars connect to them again
+  virtual void Reset(PhysiologyEngine&) { }
+};
+
+/// Stops when the patient enters (or leaves) one of the given states, i.e. asystole or an irreversible state
+/// The engine forwards its events to a single handler, give the handler the scenario already uses
+/// so it still receives every event, and forward the events of the engine to this one instead.
+class PatientEventStop : public StopCondition, public SEEventHandler
+{
+public:
+  PatientEventStop(SEEventHandler* forward = nullptr) : m_Forward(forward), m_Met(false), m_Time_s(0) { }
+
+  /// Stops when the event becomes active, or inactive
+  void Add(cdm::ePatient_Event type, bool active = true) { m_Events.push_back({ type, active }); }
+
+  void HandlePatientEvent(cdm::ePatient_Event type, bool active, const SEScalarTime* time) override
+  {
+    if (m_Forward != nullptr)
+      m_Forward->HandlePatientEvent(type, active, time);
+    if (m_Met)
+      return;
+    for (const Event& e : m_Events)
+    {
+      if (e.type == type && e.active == active)
+      {
+        m_Met = true;
+        m_Event = e;
+        m_Time_s = time == nullptr ? 0 : time->GetValue(TimeUnit::s);
+        return;
+      }
+    }
+  }
+
+  void HandleAnesthesiaMachineEvent(cdm::eAnesthesiaMachine_Event type, bool active, const SEScalarTime* time) override
+  {
+    if (m_Forward != nullptr)
+      m_Forward->HandleAnesthesiaMachineEvent(type, active, time);
+  }
+
+  bool IsMet(double) override { return m_Met; }
+
+  std::string GetReason() const override
+  {
+    return std::string("patient event ") + cdm::ePatient_Event_Name(m_Event.type) +
+           (m_Event.active ? " started at " : " ended at ") + std::to_string(m_Time_s) + "s";
+  }
+
+private:
+  struct Event
+  {
+    cdm::ePatient_Event type;
+    bool active;
+  };
+
+  SEEventHandler* m_Forward;
+  std::vector<Event> m_Events;
+  bool m_Met;
+  Event m_Event;
+  double m_Time_s;
+};
+
+// Physiology properties the engine averages over each heart beat or breath, they settle when the patient does
+#define PULSE_STEADY_STATE_CHANNELS(X) \
+  X(HeartRate, &FrequencyUnit::Per_min) \
+  X(MeanArterialPressure, &PressureUnit::mmHg) \
+  X(CardiacOutput, &VolumePerTimeUnit::mL_Per_min) \
+  X(RespirationRate, &FrequencyUnit::Per_min) \
+  X(TidalVolume, &VolumeUnit::mL) \
+  X(OxygenSaturation, nullptr)
+PULSE_CHANNEL_SCHEMA(SteadyStateVitals, PULSE_STEADY_STATE_CHANNELS)
+
+/// Stops when the patient reaches a steady state
+/// The channels are sampled every sample period, the patient is steady once the standard deviation
+/// of every channel over the last window is within the tolerance of its mean, i.e. 0.5%.
+/// Sample slower than a heart beat or a breath, and use properties averaged over them,
+/// such as the channels of SteadyStateVitals, instantaneous ones like the arterial pressure never settle.
+class SteadyStateStop : public StopCondition
+{
+public:
+  SteadyStateStop(PhysiologyEngine& pe, std::unique_ptr<ChannelSource> channels,
+                  double window_s = 30, double tolerance = 0.005, double samplePeriod_s = 1)
+    : m_Channels(std::move(channels)), m_Tolerance(tolerance), m_SamplePeriod_s(samplePeriod_s), m_NextSample_s(0),
+      m_NumSamples(0), m_Next(0), m_Time_s(0)
+  {
+    m_Channels->Setup(pe);
+    m_WindowSize = std::max<size_t>(2, static_cast<size_t>(std::lround(window_s / samplePeriod_s)));
+    m_Window.resize(m_WindowSize * m_Channels->GetNumChannels());
+    m_Window_s = window_s;
+  }
+
+  /// Steady state detection on the channels of a schema, declared with PULSE_CHANNEL_SCHEMA
+  template<typename Schema>
+  static std::unique_ptr<SteadyStateStop> Create(PhysiologyEngine& pe, double window_s = 30, double tolerance = 0.005,
+                                                 double samplePeriod_s = 1)
+  {
+    return std::unique_ptr<SteadyStateStop>(new SteadyStateStop(pe, std::unique_ptr<ChannelSource>(new TypedSampler<Schema>()),
+                                                                window_s, tolerance, samplePeriod_s));
+  }
+
+  bool IsMet(double time_s) override
+  {
+    if (time_s < m_NextSample_s)
+      return false;
+    if (m_NumSamples == 0)
+      m_NextSample_s = time_s;
+    m_NextSample_s += m_SamplePeriod_s;
+
+    size_t numChannels = m_Channels->GetNumChannels();
+    m_Channels->Sample(time_s, &m_Window[m_Next * numChannels]);
+    m_Next = (m_Next + 1) % m_WindowSize;
+    if (++m_NumSamples < m_WindowSize)
+      return false;
+
+    for (size_t c = 0; c < numChannels; c++)
+    {
+      double mean = 0;
+      for (size_t s = 0; s < m_WindowSize; s++)
+        mean += m_Window[s * numChannels + c];
+      mean /= m_WindowSize;
+      double variance = 0;
+      for (size_t s = 0; s < m_WindowSize; s++)
+      {
+        double d = m_Window[s * numChannels + c] - mean;
+        variance += d * d;
+      }
+      variance /= m_WindowSize - 1;
+      // Channels the engine does not compute are NaN, and ignored
+      if (std::sqrt(variance) > m_Tolerance * std::abs(mean))
+        return false;
+    }
+    m_Time_s = time_s;
+    return true;
+  }
+
+  /// The time skipped by the load is not part of the window, it starts over
+  void Reset(PhysiologyEngine& pe) override
+  {
+    m_Channels->Setup(pe);
+    m_NextSample_s = 0;
+    m_NumSamples = 0;
+    m_Next = 0;
+  }
+
+  std::string GetReason() const override
+  {
+    std::stringstream ss;
+    ss << "steady state at " << m_Time_s << "s, every channel within " << m_Tolerance * 100
+       << "% of its mean over the last " << m_Window_s << "s";
+    return ss.str();
+  }
+
+private:
+  std::unique_ptr<ChannelSource> m_Channels;
+  double m_Tolerance;
+  double m_SamplePeriod_s;
+  double m_NextSample_s;
+  double m_Window_s;
+  size_t m_WindowSize;           // Number of samples in the window
+  size_t m_NumSamples;           // Number of samples so far
+  size_t m_Next;                 // Where the next sample goes in the window
+  std::vector<double> m_Window;  // The samples of every channel, one sample after the other
+  double m_Time_s;
+};
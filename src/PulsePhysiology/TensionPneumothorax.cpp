@@ -23,6 +23,31 @@
 #include "engine/SEEngineTracker.h"
 #include "compartment/SECompartmentManager.h"
 
+// The values tracked during the tension pneumothorax, the schema resolves them once to the engine scalars
+#define PNEUMOTHORAX_VITALS(X) \
+  X(HeartRate, &FrequencyUnit::Per_min) \
+  X(SystolicArterialPressure, &PressureUnit::mmHg) \
+  X(DiastolicArterialPressure, &PressureUnit::mmHg) \
+  X(RespirationRate, &FrequencyUnit::Per_min) \
+  X(TidalVolume, &VolumeUnit::mL) \
+  X(TotalLungVolume, &VolumeUnit::mL) \
+  X(OxygenSaturation, nullptr) \
+  X(CardiacOutput, &VolumePerTimeUnit::mL_Per_min)
+PULSE_CHANNEL_SCHEMA(PneumothoraxVitals, PNEUMOTHORAX_VITALS)
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Logs the values we check on during the tension pneumothorax
+//--------------------------------------------------------------------------------------------------
+void LogPneumothoraxStatus(PhysiologyEngine& pe, VitalsReader& vitals)
+{
+  const VitalsSnapshot& v = vitals.Read();
+  SCENARIO_LOG_INFO(pe.GetLogger(), "Tidal Volume : {}mL, Systolic Pressure : {}mmHg, Diastolic Pressure : {}mmHg"
+                    ", Heart Rate : {}bpm, Respiration Rate : {}bpm, Oxygen Saturation : {}, Cardiac Output : {}mL/min",
+                    v.TidalVolume, v.SystolicArterialPressure, v.DiastolicArterialPressure,
+                    v.HeartRate, v.RespirationRate, v.OxygenSaturation, v.CardiacOutput);
+}
+
 //--------------------------------------------------------------------------------------------------
 /// \brief
 /// Usage for applying a Tension Pneumothorax insult to the patient
@@ -35,9 +60,9 @@
 void HowToTensionPneumothorax()
 {
   // Create the engine and load the patient
-  std::unique_ptr<PhysiologyEngine> pe = CreatePulseEngine("TensionPneumothorax.log");
-  pe->GetLogger()->Info("HowToTensionPneumothorax");
-  if (!pe->LoadStateFile("./states/StandardMale@0s.pba"))
+  PooledEngine pe = CreateScenarioEngine("TensionPneumothorax.log");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "HowToTensionPneumothorax");
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
   {
     pe->GetLogger()->Error("Could not load state, check the error");
     return;
@@ -45,28 +70,18 @@ void HowToTensionPneumothorax()
     // The tracker is responsible for advancing the engine time and outputting the data requests below at each time step
   HowToTracker tracker(*pe);
 
-  // Create data requests for each value that should be written to the output log as the engine is executing
-  // Physiology System Names are defined on the System Objects 
+  // Track the values that should be written to the output log as the engine is executing
+  // Physiology property names are defined on the System Objects
   // defined in the Physiology.xsd file
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("HeartRate", FrequencyUnit::Per_min);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("SystolicArterialPressure", PressureUnit::mmHg);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("DiastolicArterialPressure", PressureUnit::mmHg);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("RespirationRate", FrequencyUnit::Per_min);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("TidalVolume", VolumeUnit::mL);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("TotalLungVolume", VolumeUnit::mL);
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("OxygenSaturation");
-  pe->GetEngineTracker()->GetDataRequestManager().CreatePhysiologyDataRequest("CardiacOutput", VolumePerTimeUnit::mL_Per_min);
+  tracker.TrackSchema<PneumothoraxVitals>();
+  // Reads the values we log in one pass
+  VitalsReader vitals(*pe);
+  tracker.AddVitalsReader(vitals);
 
   pe->GetEngineTracker()->GetDataRequestManager().SetResultsFilename("TensionPneumothorax.csv");
 
-  pe->GetLogger()->Info("The patient is nice and healthy");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient is nice and healthy");
+  LogPneumothoraxStatus(*pe, vitals);
 
   tracker.AdvanceModelTime(50);
 
@@ -84,21 +99,16 @@ void HowToTensionPneumothorax()
   //pneumo.SetSide(CDM::enumSide::Left);
   pneumo.SetComment("ICD-9: 860.0");
   //pneumo.SetComment('ICD-9: 860.0');
-  pe->ProcessAction(pneumo);
+  tracker.ProcessAction(pneumo);
+  tracker.SetPhase(ScenarioPhase::InsultActive);
 
-  pe->GetLogger()->Info("Giving the patient a tension pneumothorax");
-  pe->GetLogger()->Info("ICD-9: 860.0");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Giving the patient a tension pneumothorax");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "ICD-9: 860.0");
 
   tracker.AdvanceModelTime(120);//This will advance the engine
 
-  pe->GetLogger()->Info("The patient has had a tension pneumothorax for 120");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);;
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient has had a tension pneumothorax for 120");
+  LogPneumothoraxStatus(*pe, vitals);
 
   // Needle Decompression should help the patient out
   SENeedleDecompression needleDecomp;
@@ -110,18 +120,16 @@ void HowToTensionPneumothorax()
   needleDecomp.SetSide(cdm::eSide::Right);
   //needleDecomp.SetSide(CDM::enumSide::Left);
   
-  pe->ProcessAction(needleDecomp);
-  pe->GetLogger()->Info("Giving the patient a needle decompression");
+  tracker.ProcessAction(needleDecomp);
+  tracker.SetPhase(ScenarioPhase::AfterIntervention);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Giving the patient a needle decompression");
+  // Stop once the patient has recovered
+  std::unique_ptr<SteadyStateStop> steadyState = SteadyStateStop::Create<SteadyStateVitals>(*pe);
+  tracker.AddStopCondition(*steadyState);
 
   tracker.AdvanceModelTime(400);
 
-  pe->GetLogger()->Info("The patient has had a needle decompressed tension pneumothorax for 400s");
-  pe->GetLogger()->Info(std::stringstream() <<"Tidal Volume : " << pe->GetRespiratorySystem()->GetTidalVolume(VolumeUnit::mL) << VolumeUnit::mL);
-  pe->GetLogger()->Info(std::stringstream() <<"Systolic Pressure : " << pe->GetCardiovascularSystem()->GetSystolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Diastolic Pressure : " << pe->GetCardiovascularSystem()->GetDiastolicArterialPressure(PressureUnit::mmHg) << PressureUnit::mmHg);
-  pe->GetLogger()->Info(std::stringstream() <<"Heart Rate : " << pe->GetCardiovascularSystem()->GetHeartRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Respiration Rate : " << pe->GetRespiratorySystem()->GetRespirationRate(FrequencyUnit::Per_min) << "bpm");
-  pe->GetLogger()->Info(std::stringstream() <<"Oxygen Saturation : " << pe->GetBloodChemistrySystem()->GetOxygenSaturation());
-  pe->GetLogger()->Info(std::stringstream() <<"Cardiac Output : " << pe->GetCardiovascularSystem()->GetCardiacOutput(VolumePerTimeUnit::mL_Per_min) << VolumePerTimeUnit::mL_Per_min);
-  pe->GetLogger()->Info("Finished");
+  SCENARIO_LOG_INFO(pe->GetLogger(), "The patient has had a needle decompressed tension pneumothorax for 400s");
+  LogPneumothoraxStatus(*pe, vitals);
+  SCENARIO_LOG_INFO(pe->GetLogger(), "Finished");
 }
\ No newline at end of file
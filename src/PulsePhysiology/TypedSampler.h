@@ -0,0 +1,186 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "CommonDataModel.h"
+#include "PulsePhysiologyEngine.h"
+#include "properties/SEScalar.h"
+#include "properties/SEGenericScalar.h"
+#include "system/SESystem.h"
+#include "system/physiology/SEBloodChemistrySystem.h"
+#include "system/physiology/SECardiovascularSystem.h"
+#include "system/physiology/SEDrugSystem.h"
+#include "system/physiology/SEEndocrineSystem.h"
+#include "system/physiology/SEEnergySystem.h"
+#include "system/physiology/SEGastrointestinalSystem.h"
+#include "system/physiology/SEHepaticSystem.h"
+#include "system/physiology/SENervousSystem.h"
+#include "system/physiology/SERenalSystem.h"
+#include "system/physiology/SERespiratorySystem.h"
+#include "system/physiology/SETissueSystem.h"
+#include "utils/unitconversion/UnitConversionEngine.h"
+#include "ChannelSource.h"
+#include <limits>
+#include <string>
+
+/// A channel of a schema: a physiology property, and the unit it is sampled in, nullptr if it has none
+struct ChannelDef
+{
+  const char* property;
+  const CCompoundUnit* unit;
+};
+
+// Declares a channel schema, a struct with a double for the time and each channel, i.e.
+//   #define MY_CHANNELS(X) X(HeartRate, &FrequencyUnit::Per_min) X(OxygenSaturation, nullptr)
+//   PULSE_CHANNEL_SCHEMA(MyVitals, MY_CHANNELS)
+// declares struct MyVitals { double time_s; double HeartRate; double OxygenSaturation; }
+#define PULSE_SCHEMA_FIELD(property, unit) double property;
+#define PULSE_SCHEMA_DEF(property, unit) { #property, unit },
+#define PULSE_SCHEMA_MEMBER(property, unit) &Self::property,
+#define PULSE_SCHEMA_COUNT(property, unit) + 1
+#define PULSE_CHANNEL_SCHEMA(Name, CHANNELS) \
+  struct Name \
+  { \
+    typedef Name Self; \
+    double time_s; \
+    CHANNELS(PULSE_SCHEMA_FIELD) \
+    static const size_t NumChannels = 0 CHANNELS(PULSE_SCHEMA_COUNT); \
+    static const ChannelDef* GetChannels() \
+    { \
+      static const ChannelDef channels[] = { CHANNELS(PULSE_SCHEMA_DEF) }; \
+      return channels; \
+    } \
+    static double Self::* const* GetFields() \
+    { \
+      static double Self::* const fields[] = { CHANNELS(PULSE_SCHEMA_MEMBER) }; \
+      return fields; \
+    } \
+  };
+
+/// Finds the scalar of a physiology property in the systems of the engine, nullptr if no system has it
+inline const SEScalar* FindPhysiologyScalar(PhysiologyEngine& pe, const std::string& property)
+{
+  const SESystem* systems[] =
+  {
+    pe.GetBloodChemistrySystem(), pe.GetCardiovascularSystem(), pe.GetDrugSystem(), pe.GetEndocrineSystem(),
+    pe.GetEnergySystem(), pe.GetGastrointestinalSystem(), pe.GetHepaticSystem(), pe.GetNervousSystem(),
+    pe.GetRenalSystem(), pe.GetRespiratorySystem(), pe.GetTissueSystem()
+  };
+  for (const SESystem* system : systems)
+  {
+    // GetScalar only looks the property up, the engine only hands out const systems
+    const SEScalar* scalar = system == nullptr ? nullptr : const_cast<SESystem*>(system)->GetScalar(property);
+    if (scalar != nullptr)
+      return scalar;
+  }
+  return nullptr;
+}
+
+/// A scalar of the engine, sampled in the requested unit
+/// The unit conversion is folded into a scale and an offset when the channel is set up.
+struct ScalarChannel
+{
+  const SEScalar* scalar = nullptr;
+  double scale = 1;
+  double offset = 0;
+
+  /// Samples the scalar in the given unit, nullptr if it has none, returns false if the unit does not apply
+  bool Setup(PhysiologyEngine& pe, const SEScalar* s, const CCompoundUnit* unit)
+  {
+    scalar = s;
+    scale = 1;
+    offset = 0;
+    if (scalar == nullptr || unit == nullptr)
+      return scalar != nullptr;
+    SEGenericScalar generic(pe.GetLogger());
+    generic.SetScalar(*scalar);
+    const CCompoundUnit* from = generic.GetUnit();
+    if (from == nullptr || !generic.IsValidUnit(*unit))
+    {
+      scalar = nullptr;
+      return false;
+    }
+    // Unit conversions are affine (i.e. degC to K), so two points define them
+    CUnitConversionEngine& converter = CUnitConversionEngine::GetEngine();
+    offset = converter.ConvertValue(0, *from, *unit);
+    scale = converter.ConvertValue(1, *from, *unit) - offset;
+    return true;
+  }
+
+  /// NaN if the scalar was not found or the engine does not compute it
+  double Sample() const
+  {
+    return scalar == nullptr || !scalar->IsValid() ? std::numeric_limits<double>::quiet_NaN()
+                                                   : scalar->GetValue() * scale + offset;
+  }
+};
+
+/// Samples the channels of a schema straight from the engine
+/// Each property is looked up once, when the sampler is set up, and its unit conversion is folded
+/// into a scale and an offset, sampling is then a loop over scalar pointers into the schema struct,
+/// with no name lookup or unit conversion. The engine keeps its scalars in the units it computes them in,
+/// set the sampler up again after loading a state, which may have been saved with other units.
+template<typename Schema>
+class TypedSampler : public ChannelSource
+{
+public:
+  TypedSampler() : m_Values() { }
+
+  /// The values of the last sample
+  const Schema& GetValues() const { return m_Values; }
+
+  bool Setup(PhysiologyEngine& pe) override
+  {
+    bool found = true;
+    const ChannelDef* channels = Schema::GetChannels();
+    for (size_t i = 0; i < Schema::NumChannels; i++)
+    {
+      const SEScalar* scalar = FindPhysiologyScalar(pe, channels[i].property);
+      if (scalar == nullptr)
+      {
+        pe.GetLogger()->Error(std::string("Unknown physiology property ") + channels[i].property);
+        m_Channels[i].scalar = nullptr;
+        found = false;
+      }
+      else if (!m_Channels[i].Setup(pe, scalar, channels[i].unit))
+      {
+        pe.GetLogger()->Error(std::string("Invalid unit for physiology property ") + channels[i].property);
+        found = false;
+      }
+    }
+    return found;
+  }
+
+  size_t GetNumChannels() const override { return Schema::NumChannels; }
+
+  std::string GetChannelName(size_t channel) const override
+  {
+    const ChannelDef& def = Schema::GetChannels()[channel];
+    std::string name = def.property;
+    if (def.unit != nullptr)
+      name += "(" + def.unit->GetString() + ")";
+    return name;
+  }
+
+  /// Samples every channel into the schema struct
+  const Schema& Sample(double time_s)
+  {
+    m_Values.time_s = time_s;
+    double Schema::* const* fields = Schema::GetFields();
+    for (size_t i = 0; i < Schema::NumChannels; i++)
+      m_Values.*fields[i] = m_Channels[i].Sample();
+    return m_Values;
+  }
+
+  void Sample(double time_s, double* values) override
+  {
+    Sample(time_s);
+    double Schema::* const* fields = Schema::GetFields();
+    for (size_t i = 0; i < Schema::NumChannels; i++)
+      values[i] = m_Values.*fields[i];
+  }
+
+private:
+  Schema m_Values;
+  ScalarChannel m_Channels[Schema::NumChannels];
+};
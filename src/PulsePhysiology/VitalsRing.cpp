@@ -0,0 +1,235 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+
+#include "VitalsRing.h"
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VitalsRing
+{
+  // Slots and the sequence of the header are on their own cache lines, readers do not slow the writer down
+  static const uint64_t CacheLine = 64;
+
+  static uint64_t RoundUp(uint64_t size)
+  {
+    return (size + CacheLine - 1) / CacheLine * CacheLine;
+  }
+
+  // Values are stored as the bits of the doubles, so the copies under the sequence lock are not data races
+  static std::atomic<uint64_t>* GetSlot(char* slots, const Header& header, uint64_t index)
+  {
+    return reinterpret_cast<std::atomic<uint64_t>*>(slots + (index % header.capacity) * header.slotSize);
+  }
+
+  static const std::atomic<uint64_t>* GetSlot(const char* slots, const Header& header, uint64_t index)
+  {
+    return reinterpret_cast<const std::atomic<uint64_t>*>(slots + (index % header.capacity) * header.slotSize);
+  }
+
+  std::string GetName(const std::string& resultsFilename)
+  {
+    std::string name = resultsFilename;
+    size_t slash = name.find_last_of("/\\");
+    if (slash != std::string::npos)
+      name = name.substr(slash + 1);
+    name = name.substr(0, name.find_last_of('.'));
+    return "/PulsePhysiology." + name;
+  }
+
+  Writer::Writer() : m_Header(nullptr), m_Slots(nullptr), m_Size(0) { }
+  Writer::~Writer() { Close(); }
+
+  bool Writer::Open(const std::string& name, const std::vector<std::string>& columnNames, uint64_t capacity)
+  {
+    Close();
+    if (columnNames.empty() || capacity == 0)
+      return false;
+#ifdef _WIN32
+    (void)name;
+    return false;
+#else
+    std::string names;
+    for (const std::string& column : columnNames)
+      names += column + "\n";
+    uint64_t namesOffset = sizeof(Header);
+    uint64_t slotsOffset = RoundUp(namesOffset + names.size());
+    uint64_t slotSize = RoundUp((1 + columnNames.size()) * sizeof(uint64_t));
+    size_t size = static_cast<size_t>(slotsOffset + capacity * slotSize);
+
+    // A ring left by a run that crashed, or by the previous run of the scenario, is replaced
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+      return false;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+      close(fd);
+      shm_unlink(name.c_str());
+      return false;
+    }
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+      shm_unlink(name.c_str());
+      return false;
+    }
+
+    // The memory is zeroed, so every slot lock is 0, no row was written in it
+    char* memory = static_cast<char*>(data);
+    Header* header = new (memory) Header();
+    std::memcpy(header->magic, Magic, sizeof(Magic));
+    header->numColumns = static_cast<uint32_t>(columnNames.size());
+    header->capacity = capacity;
+    header->slotSize = slotSize;
+    header->namesOffset = namesOffset;
+    header->namesSize = names.size();
+    header->slotsOffset = slotsOffset;
+    header->sequence.store(0, std::memory_order_relaxed);
+    header->closed.store(0, std::memory_order_relaxed);
+    std::memcpy(memory + namesOffset, names.data(), names.size());
+    header->version.store(Version, std::memory_order_release);
+
+    m_Name = name;
+    m_Header = header;
+    m_Slots = memory + slotsOffset;
+    m_Size = size;
+    return true;
+#endif
+  }
+
+  void Writer::Close()
+  {
+    if (m_Header == nullptr)
+      return;
+#ifndef _WIN32
+    m_Header->closed.store(1, std::memory_order_release);
+    munmap(m_Header, m_Size);
+    shm_unlink(m_Name.c_str());
+#endif
+    m_Header = nullptr;
+    m_Slots = nullptr;
+    m_Size = 0;
+  }
+
+  void Writer::Publish(const double* row)
+  {
+    uint64_t index = m_Header->sequence.load(std::memory_order_relaxed);
+    std::atomic<uint64_t>* slot = GetSlot(m_Slots, *m_Header, index);
+    // Readers that copy the slot from here on see an odd lock, or a different lock once we are done
+    slot[0].store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (uint32_t c = 0; c < m_Header->numColumns; c++)
+    {
+      uint64_t bits;
+      std::memcpy(&bits, &row[c], sizeof(bits));
+      slot[1 + c].store(bits, std::memory_order_relaxed);
+    }
+    slot[0].store(2 * index + 2, std::memory_order_release);
+    m_Header->sequence.store(index + 1, std::memory_order_release);
+  }
+
+  Reader::Reader() : m_Header(nullptr), m_Slots(nullptr), m_Size(0) { }
+  Reader::~Reader() { Close(); }
+
+  bool Reader::Open(const std::string& name)
+  {
+    Close();
+#ifdef _WIN32
+    (void)name;
+    return false;
+#else
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header))
+    {
+      close(fd);
+      return false;
+    }
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+      return false;
+    m_Header = static_cast<const Header*>(data);
+    m_Size = static_cast<size_t>(st.st_size);
+
+    // The version is written last, once it is there the rest of the header is
+    if (std::memcmp(m_Header->magic, Magic, sizeof(Magic)) != 0 ||
+        m_Header->version.load(std::memory_order_acquire) != Version ||
+        m_Header->slotsOffset + m_Header->capacity * m_Header->slotSize > m_Size ||
+        m_Header->namesOffset + m_Header->namesSize > m_Size)
+    {
+      Close();
+      return false;
+    }
+    const char* memory = static_cast<const char*>(data);
+    std::string names(memory + m_Header->namesOffset, static_cast<size_t>(m_Header->namesSize));
+    size_t start = 0, end;
+    while ((end = names.find('\n', start)) != std::string::npos)
+    {
+      m_ColumnNames.push_back(names.substr(start, end - start));
+      start = end + 1;
+    }
+    m_Slots = memory + m_Header->slotsOffset;
+    return true;
+#endif
+  }
+
+  void Reader::Close()
+  {
+#ifndef _WIN32
+    if (m_Header != nullptr)
+      munmap(const_cast<Header*>(m_Header), m_Size);
+#endif
+    m_Header = nullptr;
+    m_Slots = nullptr;
+    m_Size = 0;
+    m_ColumnNames.clear();
+  }
+
+  uint64_t Reader::GetSequence() const
+  {
+    return m_Header->sequence.load(std::memory_order_acquire);
+  }
+
+  bool Reader::IsClosed() const
+  {
+    return m_Header->closed.load(std::memory_order_acquire) != 0;
+  }
+
+  uint64_t Reader::GetOldest() const
+  {
+    // The writer may be overwriting the oldest slot, it is skipped
+    uint64_t sequence = GetSequence();
+    return sequence < m_Header->capacity ? 0 : sequence - m_Header->capacity + 1;
+  }
+
+  Reader::Status Reader::Read(uint64_t index, double* row) const
+  {
+    const std::atomic<uint64_t>* slot = GetSlot(m_Slots, *m_Header, index);
+    uint64_t lock = slot[0].load(std::memory_order_acquire);
+    if (lock < 2 * index + 2)
+      return Status::NotYet;
+    if (lock > 2 * index + 2)
+      return Status::Overwritten;
+    for (uint32_t c = 0; c < m_Header->numColumns; c++)
+    {
+      uint64_t bits = slot[1 + c].load(std::memory_order_relaxed);
+      std::memcpy(&row[c], &bits, sizeof(bits));
+    }
+    // The copy is only valid if the writer did not start on the slot again meanwhile
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot[0].load(std::memory_order_relaxed) != lock)
+      return Status::Overwritten;
+    return Status::Read;
+  }
+}
@@ -0,0 +1,110 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Ring of result rows in POSIX shared memory, so monitors in other processes can follow a run live
+///
+/// The shared memory starts with a header:
+///   char[8]  magic "PPVRINGS"
+///   uint32   version, written last once the ring is set up
+///   uint32   number of columns, the first column is the time in seconds
+///   uint64   capacity, the number of rows the ring holds
+///   uint64   slot size, offset of the column names, size of the column names, offset of the first slot
+///   uint64   sequence, the number of rows published so far, on its own cache line
+///   uint32   closed, set once the run is over
+/// followed by the column names, each ended by '\n', and by the slots. Row n is in slot n % capacity,
+/// a slot is a uint64 sequence lock, 2n + 1 while row n is being written and 2n + 2 once it is,
+/// followed by the values of the row.
+/// The writer never waits on readers, a reader copies a row and checks the lock did not change meanwhile,
+/// a reader more than capacity rows behind finds its rows overwritten and skips ahead.
+/// Reading a row is a few loads from the shared memory, with no system call.
+namespace VitalsRing
+{
+  static const char     Magic[8] = { 'P', 'P', 'V', 'R', 'I', 'N', 'G', 'S' };
+  static const uint32_t Version = 1;
+  static const uint64_t DefaultCapacity = 4096;
+
+  struct Header
+  {
+    char magic[8];
+    std::atomic<uint32_t> version;
+    uint32_t numColumns;
+    uint64_t capacity;
+    uint64_t slotSize;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+    uint64_t slotsOffset;
+    alignas(64) std::atomic<uint64_t> sequence;
+    std::atomic<uint32_t> closed;
+  };
+
+  /// Shared memory name of the ring of a results file, i.e. /PulsePhysiology.CPR for ./CPR.csv
+  std::string GetName(const std::string& resultsFilename);
+
+  /// Publishes rows to a new ring, replacing any ring with the same name
+  class Writer
+  {
+  public:
+    Writer();
+    ~Writer();
+
+    /// Creates the ring, columnNames includes the time column
+    bool Open(const std::string& name, const std::vector<std::string>& columnNames, uint64_t capacity = DefaultCapacity);
+    /// Marks the ring closed and removes its name, readers that opened it can still read it
+    void Close();
+    bool IsOpen() const { return m_Header != nullptr; }
+    const std::string& GetName() const { return m_Name; }
+
+    /// Publishes a row, one value per column, never waits
+    void Publish(const double* row);
+
+  private:
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    std::string m_Name;
+    Header* m_Header;
+    char* m_Slots;
+    size_t m_Size;
+  };
+
+  /// Follows the rows of a ring
+  class Reader
+  {
+  public:
+    enum class Status { Read, NotYet, Overwritten };
+
+    Reader();
+    ~Reader();
+
+    /// Opens the ring, returns false if there is none or it is not set up yet
+    bool Open(const std::string& name);
+    void Close();
+    bool IsOpen() const { return m_Header != nullptr; }
+
+    const std::vector<std::string>& GetColumnNames() const { return m_ColumnNames; }
+    /// The number of rows published so far
+    uint64_t GetSequence() const;
+    /// Whether the run is over, the last rows may still be read
+    bool IsClosed() const;
+    /// The index of the oldest row that can still be read
+    uint64_t GetOldest() const;
+
+    /// Copies row index, one value per column
+    Status Read(uint64_t index, double* row) const;
+
+  private:
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    const Header* m_Header;
+    const char* m_Slots;
+    size_t m_Size;
+    std::vector<std::string> m_ColumnNames;
+  };
+}
@@ -0,0 +1,70 @@
+/* Distributed under the Apache License, Version 2.0.
+   See accompanying NOTICE file for details.*/
+#pragma once
+
+#include "properties/SEScalarFrequency.h"
+#include "properties/SEScalarMass.h"
+#include "properties/SEScalarPressure.h"
+#include "properties/SEScalarTemperature.h"
+#include "properties/SEScalarTime.h"
+#include "properties/SEScalarVolume.h"
+#include "properties/SEScalarVolumePerTime.h"
+#include "TypedSampler.h"
+#include <ostream>
+
+// The common cardiovascular, respiratory and blood chemistry values, in the units the scenarios log them in
+#define PULSE_VITALS_CHANNELS(X) \
+  X(HeartRate, &FrequencyUnit::Per_min) \
+  X(SystolicArterialPressure, &PressureUnit::mmHg) \
+  X(DiastolicArterialPressure, &PressureUnit::mmHg) \
+  X(MeanArterialPressure, &PressureUnit::mmHg) \
+  X(ArterialPressure, &PressureUnit::mmHg) \
+  X(HeartStrokeVolume, &VolumeUnit::mL) \
+  X(HeartEjectionFraction, nullptr) \
+  X(CardiacOutput, &VolumePerTimeUnit::mL_Per_min) \
+  X(CerebralBloodFlow, &VolumePerTimeUnit::mL_Per_min) \
+  X(CerebralPerfusionPressure, &PressureUnit::mmHg) \
+  X(IntracranialPressure, &PressureUnit::mmHg) \
+  X(RespirationRate, &FrequencyUnit::Per_min) \
+  X(TidalVolume, &VolumeUnit::mL) \
+  X(TotalLungVolume, &VolumeUnit::mL) \
+  X(InspiratoryExpiratoryRatio, nullptr) \
+  X(OxygenSaturation, nullptr) \
+  X(CarbonDioxideSaturation, nullptr) \
+  X(CarbonMonoxideSaturation, nullptr) \
+  X(PulseOximetry, nullptr) \
+  X(HemoglobinContent, &MassUnit::g) \
+  X(CoreTemperature, &TemperatureUnit::C)
+
+/// The common vitals of a patient at one point in time
+PULSE_CHANNEL_SCHEMA(VitalsSnapshot, PULSE_VITALS_CHANNELS)
+
+/// Reads all the vitals of an engine in one pass
+/// The engine scalars and unit conversions are resolved when the reader is created,
+/// so reading is cheap enough to be done at every time step, i.e. to drive a SOFA scene.
+/// Reset the reader after loading a state into the engine, a HowToTracker resets the readers added to it.
+class VitalsReader
+{
+public:
+  VitalsReader(PhysiologyEngine& engine) : m_Engine(engine) { m_Sampler.Setup(engine); }
+
+  /// Connects to the scalars of the engine again, call after loading a state into it
+  void Reset() { m_Sampler.Setup(m_Engine); }
+
+  const VitalsSnapshot& Read() { return m_Sampler.Sample(m_Engine.GetSimulationTime(TimeUnit::s)); }
+  /// The last values read
+  const VitalsSnapshot& GetSnapshot() const { return m_Sampler.GetValues(); }
+
+  /// Writes every vital as name(unit) : value, separated by commas
+  void Write(std::ostream& out) const
+  {
+    const VitalsSnapshot& vitals = GetSnapshot();
+    double VitalsSnapshot::* const* fields = VitalsSnapshot::GetFields();
+    for (size_t i = 0; i < VitalsSnapshot::NumChannels; i++)
+      out << (i == 0 ? "" : ", ") << m_Sampler.GetChannelName(i) << " : " << vitals.*fields[i];
+  }
+
+private:
+  PhysiologyEngine& m_Engine;
+  TypedSampler<VitalsSnapshot> m_Sampler;
+};
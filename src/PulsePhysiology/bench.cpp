@@ -0,0 +1,140 @@
+/* Distributed under the Apache License, Version 2.0.*/
+
+/// Throughput benchmark of the how-to scenarios
+/// Runs each scenario headless for a number of repetitions and writes, for each of them,
+/// the engine creation time, state load time, steps per second, per step latency percentiles
+/// and the ratio of simulated time to wall time, as JSON
+#include "Scenarios.h"
+#include <fstream>
+#include <stdlib.h>
+
+void PrintUsage()
+{
+  std::cout << "\nUsage: PulsePhysiologyBench [-r repetitions] [-o results.json] [--cold] [--pool] <condition> [condition ...]\n";
+  std::cout << "  Use 'all' to benchmark every condition\n";
+  std::cout << "  Use --cold to drop the in-memory state cache, and the idle engines, before each repetition\n";
+  std::cout << "  Use --pool to reuse the engines of the previous repetitions, rather than constructing new ones\n";
+}
+
+struct BenchmarkResult
+{
+  const ScenarioInfo* scenario;
+  std::vector<ScenarioMetrics> runs;
+};
+
+static void WriteRun(std::ostream& out, const ScenarioMetrics& m)
+{
+  out << "{ \"engine_creation_s\": " << m.engineCreation_s
+      << ", \"state_load_s\": " << m.stateLoad_s
+      << ", \"stepping_s\": " << m.stepping_s
+      << ", \"sim_time_s\": " << m.simTime_s
+      << ", \"steps\": " << m.GetNumSteps()
+      << ", \"steps_per_s\": " << m.GetStepsPerSecond()
+      << ", \"step_p50_s\": " << m.GetStepLatencyPercentile(0.50)
+      << ", \"step_p99_s\": " << m.GetStepLatencyPercentile(0.99)
+      << ", \"sim_to_wall\": " << m.GetSimToWallRatio() << " }";
+}
+
+static void WriteResults(std::ostream& out, const std::vector<BenchmarkResult>& results)
+{
+  out.precision(9);
+  out << "{\n  \"scenarios\": [\n";
+  for (size_t s = 0; s < results.size(); s++)
+  {
+    const BenchmarkResult& result = results[s];
+    // Aggregate all repetitions, the latency percentiles are taken over every step of every repetition
+    ScenarioMetrics total;
+    for (const ScenarioMetrics& run : result.runs)
+    {
+      total.engineCreation_s += run.engineCreation_s / result.runs.size();
+      total.stateLoad_s += run.stateLoad_s / result.runs.size();
+      total.stepping_s += run.stepping_s;
+      total.simTime_s += run.simTime_s;
+      total.stepLatencies_s.insert(total.stepLatencies_s.end(), run.stepLatencies_s.begin(), run.stepLatencies_s.end());
+    }
+
+    out << "    {\n      \"name\": \"" << result.scenario->name << "\",\n";
+    out << "      \"repetitions\": " << result.runs.size() << ",\n";
+    out << "      \"mean\": ";
+    WriteRun(out, total);
+    out << ",\n      \"runs\": [\n";
+    for (size_t r = 0; r < result.runs.size(); r++)
+    {
+      out << "        ";
+      WriteRun(out, result.runs[r]);
+      out << (r + 1 < result.runs.size() ? ",\n" : "\n");
+    }
+    out << "      ]\n    }" << (s + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+}
+
+int main(int argc, char* argv[])
+{
+  size_t repetitions = 3;
+  bool cold = false;
+  std::string output = "PulsePhysiologyBench.json";
+  std::vector<const ScenarioInfo*> scenarios;
+  for (int a = 1; a < argc; a++)
+  {
+    if (strcmp(argv[a], "-r") == 0 && a + 1 < argc)
+      repetitions = static_cast<size_t>(std::max(1, atoi(argv[++a])));
+    else if (strcmp(argv[a], "-o") == 0 && a + 1 < argc)
+      output = argv[++a];
+    else if (strcmp(argv[a], "--cold") == 0)
+      cold = true;
+    else if (strcmp(argv[a], "--pool") == 0)
+      EnginePool::GetDefaultEnabled() = true;
+    else if (strcmp(argv[a], "all") == 0)
+    {
+      for (size_t i = 0; i < NumScenarios; i++)
+        scenarios.push_back(&Scenarios[i]);
+    }
+    else
+    {
+      const ScenarioInfo* scenario = FindScenario(argv[a]);
+      if (scenario == nullptr)
+      {
+        std::cout << "\nUNKNOWN STATE ENTERED : " << argv[a] << "\n";
+        PrintUsage();
+        return 1;
+      }
+      scenarios.push_back(scenario);
+    }
+  }
+  if (scenarios.empty())
+  {
+    PrintUsage();
+    return 1;
+  }
+
+  // Scenarios are run one at a time so they do not compete for cores or memory bandwidth
+  ScenarioLogToConsole() = false;
+  std::vector<BenchmarkResult> results;
+  for (const ScenarioInfo* scenario : scenarios)
+  {
+    BenchmarkResult result;
+    result.scenario = scenario;
+    result.runs.resize(repetitions);
+    for (size_t r = 0; r < repetitions; r++)
+    {
+      if (cold)
+      {
+        PatientStateCache::GetInstance().Clear();
+        EnginePool::GetInstance().Clear();
+      }
+      ScenarioMetrics::Current() = &result.runs[r];
+      scenario->run();
+      ScenarioMetrics::Current() = nullptr;
+      std::cout << scenario->name << " " << r + 1 << "/" << repetitions << " : "
+                << result.runs[r].GetStepsPerSecond() << " steps/s, "
+                << result.runs[r].GetSimToWallRatio() << "x real time\n";
+    }
+    results.push_back(result);
+  }
+
+  std::ofstream out(output);
+  WriteResults(out, results);
+  std::cout << "Results written to " << output << "\n";
+  return out ? 0 : 1;
+}
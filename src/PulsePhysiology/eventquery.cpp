@@ -0,0 +1,62 @@
+/* Distributed under the Apache License, Version 2.0.*/
+
+/// Lists the first time an event became active in each of the given runs, from the index of their events files
+/// i.e. PulsePhysiologyEvents Patient.IrreversibleState CPRSweep_*.events
+/// Without an event, lists the events of each run with their first time and number of records.
+#include "EventStore.h"
+#include <cmath>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cout << "\nUsage: PulsePhysiologyEvents [event] <file.events> [file.events ...]\n";
+    return 1;
+  }
+  // Event names contain a '.', like the files, but files end with .events
+  std::string event;
+  int first = 1;
+  std::string arg = argv[1];
+  if (arg.size() < 7 || arg.compare(arg.size() - 7, 7, ".events") != 0)
+  {
+    event = arg;
+    first = 2;
+  }
+
+  int failed = 0;
+  for (int a = first; a < argc; a++)
+  {
+    std::vector<EventStore::IndexEntry> index;
+    if (!EventStore::ReadIndex(argv[a], index))
+    {
+      std::cout << argv[a] << " : unable to read\n";
+      failed++;
+      continue;
+    }
+    if (!event.empty())
+    {
+      double time_s = NAN;
+      for (const EventStore::IndexEntry& e : index)
+        if (e.name == event)
+          time_s = e.firstActive_s;
+      std::cout << argv[a] << " : ";
+      if (std::isnan(time_s))
+        std::cout << "never\n";
+      else
+        std::cout << time_s << "s\n";
+      continue;
+    }
+    std::cout << argv[a] << "\n";
+    for (const EventStore::IndexEntry& e : index)
+    {
+      std::cout << "  " << e.name << " : ";
+      if (std::isnan(e.firstActive_s))
+        std::cout << "never active";
+      else
+        std::cout << "first active at " << e.firstActive_s << "s";
+      std::cout << ", " << e.count << " records\n";
+    }
+  }
+  return failed == 0 ? 0 : 1;
+}
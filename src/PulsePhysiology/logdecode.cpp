@@ -0,0 +1,42 @@
+/* Distributed under the Apache License, Version 2.0.*/
+
+/// Formats the records of a binary scenario log, written with --binary-log, to text
+/// Each line is the time of the record since the first one written, in seconds, the log it was written for,
+/// its level and its message. Give the name of a log, i.e. CPR.log, to only keep its records.
+#include "BinaryLog.h"
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cout << "\nUsage: PulsePhysiologyLogDecode <file> [log]\n";
+    return 1;
+  }
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in)
+  {
+    std::cout << "Unable to open " << argv[1] << "\n";
+    return 1;
+  }
+  std::stringstream text;
+  bool decoded = BinaryLog::Decode(in, argc > 2 ? text : std::cout);
+  if (argc > 2)
+  {
+    // Keep the lines of the given log, the second field of each line
+    std::string source = std::string(" ") + argv[2] + " ";
+    std::string line;
+    while (std::getline(text, line))
+    {
+      size_t space = line.find(' ');
+      if (space != std::string::npos && line.compare(space, source.size(), source) == 0)
+        std::cout << line << "\n";
+    }
+  }
+  if (!decoded)
+  {
+    std::cout << "The log is truncated or is not a binary scenario log\n";
+    return 1;
+  }
+  return 0;
+}
@@ -2,57 +2,285 @@
 // Include the various types you will be using in your code
 
 /// The class in this file is here to demonstrate executing the engine
-/// and populating a txt file with data from the engine 
+/// and populating a txt file with data from the engine
 /// This class will handle advancing time on the engine
-#include "AirwayObstruction.cpp"
-#include "AnesthesiaMachine.cpp"
-#include "Asthma.cpp"
-#include "BolusDrug.cpp"
-#include "BrainInjury.cpp"
-#include "COPD.cpp"
-#include "CPR.cpp"
-#include "LobarPneumonia.cpp"
-#include "PulmonaryFunctionTest.cpp"
-#include "Smoke.cpp"
-#include "TensionPneumothorax.cpp"
-#include <string.h>
+#include "Scenarios.h"
+#include "JobPool.h"
+#include <fstream>
+#include <stdlib.h>
+
+void PrintUsage()
+{
+  std::cout << "\nUsage: PulsePhysiology [-j threads] [--stabilize] [--sample-period seconds] [--binary] [--profile] [--realtime] [--checkpoint] [--memoize] [--pool] [--early-stop] [--events] [--shm] [--patients count] [--binary-log file] <condition> [condition ...]\n";
+  std::cout << "  Use 'all' to run every condition\n";
+  std::cout << "  Use --stabilize to only fill the stabilized state library with the conditions of the given scenarios\n";
+  std::cout << "  Use --sample-period to write the results every given number of seconds instead of every time step\n";
+  std::cout << "  Use --binary to write the results to a binary columnar .bin file instead of a .csv file\n";
+  std::cout << "  Use --realtime to step the engines in lockstep with the wall clock, deadline misses are reported in the log\n";
+  std::cout << "  Use --checkpoint to save the engine state along each scenario, re-runs resume from the last state their actions share\n";
+  std::cout << "  Use --memoize to store the results of each run in ./results, identical runs copy the stored results instead of running again\n";
+  std::cout << "  Use --pool to reuse the engines of finished runs for the next ones, rather than constructing a new engine for each run\n";
+  std::cout << "  Use --early-stop to end the runs once their outcome is decided, i.e. the patient reached a steady state or an irreversible state\n";
+  std::cout << "  Use --events to write the events of each run, with their time, to <results>.events, query them with PulsePhysiologyEvents\n";
+  std::cout << "  Use --shm to stream the results rows of each run to shared memory, follow them live with PulsePhysiologyMonitor <condition>\n";
+  std::cout << "  Use --patients to set the number of patients of the MassCasualty condition, all run in real time in this process\n";
+  std::cout << "  Use --binary-log to record the scenario status lines to a single binary file, formatted afterwards with PulsePhysiologyLogDecode\n";
+  std::cout << "  Use --profile to write the time spent in each engine call, for each phase of the scenario, to <condition>.profile.txt\n";
+  std::cout << "  Available conditions :";
+  for (size_t i = 0; i < NumScenarios; i++)
+    std::cout << " " << Scenarios[i].name;
+  std::cout << "\n";
+}
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Returns the command line options that change the results of a scenario
+//--------------------------------------------------------------------------------------------------
+std::string GetResultsOptions()
+{
+  std::stringstream options;
+  options << "sample-period " << ResultsSampler::GetDefaultSamplePeriod()
+          << " binary " << (ResultsSampler::GetDefaultFormat() == ResultsSampler::Format::Binary)
+          << " realtime " << HowToTracker::GetDefaultRealTime()
+          << " checkpoint " << ScenarioCheckpoints::GetDefaultEnabled()
+          << " early-stop " << HowToTracker::GetDefaultEarlyStop()
+          << " events " << HowToTracker::GetDefaultRecordEvents()
+          << " binary-log " << BinaryLog::IsOpen()
+          << " patients " << MassCasualtyNumPatients();
+  return options.str();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Checks that a checkpoint loads back into an engine before the scenarios rely on them
+//--------------------------------------------------------------------------------------------------
+bool CheckCheckpoints()
+{
+  PooledEngine pe = CreateScenarioEngine("CheckpointCheck.log");
+  pe->GetLogger()->LogToConsole(false);
+  if (!LoadCachedState(*pe, "./states/StandardMale@0s.pba"))
+    return false;
+  return ScenarioCheckpoints::CheckRoundTrip(*pe);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Runs a scenario, or restores the results of an identical run when memoizing
+//--------------------------------------------------------------------------------------------------
+void RunMemoizedScenario(const ScenarioInfo& scenario)
+{
+  std::string key = ResultStore::GetKey(scenario.name, GetResultsOptions(), PULSE_PHYSIOLOGY_PULSE_VERSION);
+  if (ResultStore::GetInstance().Restore(key))
+  {
+    std::cout << scenario.name << " : restored the results of an identical run\n";
+    return;
+  }
+  ScenarioFiles files;
+  ScenarioFiles::Current() = &files;
+  scenario.run();
+  ScenarioFiles::Current() = nullptr;
+  if (!ResultStore::GetInstance().Store(key, files))
+    std::cout << scenario.name << " : unable to store the results\n";
+}
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Runs a scenario, profiling its engine calls if asked to
+/// Profiled runs are never memoized, the point is to measure them
+//--------------------------------------------------------------------------------------------------
+void RunScenario(const ScenarioInfo& scenario, bool profile, bool memoize)
+{
+  if (!profile)
+  {
+    if (memoize)
+      RunMemoizedScenario(scenario);
+    else
+      scenario.run();
+    return;
+  }
+  std::unique_ptr<PhaseProfiler> profiler(new PhaseProfiler());
+  PhaseProfiler::Current() = profiler.get();
+  scenario.run();
+  PhaseProfiler::Current() = nullptr;
+  std::ofstream out(std::string(scenario.name) + ".profile.txt");
+  profiler->Write(out);
+}
 
 //--------------------------------------------------------------------------------------------------
 /// \brief
-/// Usage for applying a Hemorrhage insult to the patient
+/// Writes the last records of the binary log, if one is open, and reports the records that were dropped
+//--------------------------------------------------------------------------------------------------
+void CloseBinaryLog()
+{
+  if (!BinaryLog::IsOpen())
+    return;
+  BinaryLog::Close();
+  if (BinaryLog::GetNumDropped() > 0)
+    std::cout << "\n" << BinaryLog::GetNumDropped() << " records were dropped from the binary log, the scenarios logged faster than it was written\n";
+}
+
+//--------------------------------------------------------------------------------------------------
+/// \brief
+/// Runs one or more how-to scenarios
 ///
 /// \details
-/// Refer to the SEHemorrhage class
-/// Refer to the SESubstanceManager class
-/// Refer to the SESubstanceIVFluids class for applying an IV to the patient
+/// When more than one scenario is requested, they are run in parallel, one engine per worker thread,
+/// with the longest scenarios started first so that they do not hold up the end of the batch.
+/// Each scenario writes its own log and csv file, so they do not interfere with each other.
 //--------------------------------------------------------------------------------------------------
 int main(int argc, char* argv[])
 {
-  if ( strcmp( argv[1], "AirwayObstruction") == 0 )
-      HowToAirwayObstruction();
-  else if ( strcmp( argv[1], "AnesthesiaMachine") == 0)
-      HowToAnesthesiaMachine();
-  else if ( strcmp( argv[1], "Asthma") == 0)
-      HowToAsthmaAttack();
-  else if ( strcmp( argv[1], "BolusDrug") == 0)
-      HowToBolusDrug();
-  else if ( strcmp( argv[1], "BrainInjury") == 0)
-      HowToBrainInjury();
-  else if ( strcmp( argv[1], "COPD") == 0)
-      HowToCOPD();
-  else if ( strcmp( argv[1], "CPR") == 0)
-      HowToCPR();
-  else if ( strcmp( argv[1], "LobarPneumonia") == 0)
-      HowToLobarPneumonia();
-  else if ( strcmp( argv[1], "PulmonaryFunctionTest") == 0)
-      HowToPulmonaryFunctionTest();
-  else if ( strcmp( argv[1], "Smoke") == 0)
-      HowToSmoke();
-  else if ( strcmp( argv[1], "TensionPneumothorax") == 0)
-      HowToTensionPneumothorax();
-  else if ( strcmp( argv[1], "AnesthesiaMachine") == 0)
-      HowToAnesthesiaMachine();  
-  else {
-      std::cout<<"\nUNKNOWN STATE ENTERED \n Try again";
-        }
+  size_t numThreads = 0;
+  bool stabilizeOnly = false;
+  bool profile = false;
+  bool memoize = false;
+  std::vector<const ScenarioInfo*> scenarios;
+  for (int a = 1; a < argc; a++)
+  {
+    if (strcmp(argv[a], "-j") == 0 && a + 1 < argc)
+    {
+      numThreads = static_cast<size_t>(atoi(argv[++a]));
+    }
+    else if (strcmp(argv[a], "--sample-period") == 0 && a + 1 < argc)
+    {
+      ResultsSampler::GetDefaultSamplePeriod() = atof(argv[++a]);
+    }
+    else if (strcmp(argv[a], "--binary") == 0)
+    {
+      ResultsSampler::GetDefaultFormat() = ResultsSampler::Format::Binary;
+    }
+    else if (strcmp(argv[a], "--realtime") == 0)
+    {
+      HowToTracker::GetDefaultRealTime() = true;
+    }
+    else if (strcmp(argv[a], "--checkpoint") == 0)
+    {
+      ScenarioCheckpoints::GetDefaultEnabled() = true;
+    }
+    else if (strcmp(argv[a], "--early-stop") == 0)
+    {
+      HowToTracker::GetDefaultEarlyStop() = true;
+    }
+    else if (strcmp(argv[a], "--events") == 0)
+    {
+      HowToTracker::GetDefaultRecordEvents() = true;
+    }
+    else if (strcmp(argv[a], "--shm") == 0)
+    {
+      ResultsSampler::GetDefaultSharedMemory() = true;
+    }
+    else if (strcmp(argv[a], "--patients") == 0 && a + 1 < argc)
+    {
+      MassCasualtyNumPatients() = static_cast<size_t>(std::max(1, atoi(argv[++a])));
+    }
+    else if (strcmp(argv[a], "--pool") == 0)
+    {
+      EnginePool::GetDefaultEnabled() = true;
+    }
+    else if (strcmp(argv[a], "--memoize") == 0)
+    {
+      memoize = true;
+    }
+    else if (strcmp(argv[a], "--binary-log") == 0 && a + 1 < argc)
+    {
+      if (!BinaryLog::Open(argv[++a]))
+      {
+        std::cout << "\nUnable to open the binary log " << argv[a] << "\n";
+        return 1;
+      }
+    }
+    else if (strcmp(argv[a], "--profile") == 0)
+    {
+      profile = true;
+    }
+    else if (strcmp(argv[a], "--stabilize") == 0)
+    {
+      stabilizeOnly = true;
+    }
+    else if (strcmp(argv[a], "all") == 0)
+    {
+      for (size_t i = 0; i < NumScenarios; i++)
+        scenarios.push_back(&Scenarios[i]);
+    }
+    else
+    {
+      const ScenarioInfo* scenario = FindScenario(argv[a]);
+      if (scenario == nullptr)
+      {
+        std::cout << "\nUNKNOWN STATE ENTERED : " << argv[a] << "\n Try again";
+        PrintUsage();
+        return 1;
+      }
+      scenarios.push_back(scenario);
+    }
+  }
+  if (stabilizeOnly)
+  {
+    // Only keep the scenarios that start from a stabilized condition, the library is filled in parallel below
+    std::vector<const ScenarioInfo*> conditions;
+    for (const ScenarioInfo* scenario : scenarios)
+      if (scenario->stabilize != nullptr)
+        conditions.push_back(scenario);
+    scenarios = conditions;
+    if (scenarios.empty())
+    {
+      std::cout << "\nNone of the given conditions need to be stabilized\n";
+      return 0;
+    }
+  }
+  else if (scenarios.empty())
+  {
+    PrintUsage();
+    return 1;
+  }
+
+  if (ScenarioCheckpoints::GetDefaultEnabled() && !stabilizeOnly && !CheckCheckpoints())
+  {
+    std::cout << "\nCheckpoints do not load back into the engine, running without them\n";
+    ScenarioCheckpoints::GetDefaultEnabled() = false;
+  }
+
+  // Streamed runs are never memoized, a monitor has to see them run
+  if (ResultsSampler::GetDefaultSharedMemory())
+    memoize = false;
+
+  if (scenarios.size() == 1)
+  {
+    if (stabilizeOnly)
+      scenarios[0]->stabilize();
+    else
+      RunScenario(*scenarios[0], profile, memoize);
+    CloseBinaryLog();
+    return 0;
+  }
+
+  // Real time scenarios would miss their deadlines sharing the cores with the batch,
+  // they are run one after the other once the batch is done
+  std::vector<const ScenarioInfo*> batch, realTime;
+  for (const ScenarioInfo* scenario : scenarios)
+  {
+    if (scenario->realTime && !stabilizeOnly)
+      realTime.push_back(scenario);
+    else
+      batch.push_back(scenario);
+  }
+
+  if (!batch.empty())
+  {
+    if (numThreads == 0 || numThreads > batch.size())
+      numThreads = std::min<size_t>(batch.size(), std::max(1u, std::thread::hardware_concurrency()));
+    JobPool pool(numThreads);
+    for (const ScenarioInfo* scenario : batch)
+    {
+      if (stabilizeOnly)
+        pool.Add(scenario->stabilize, scenario->expectedCost_s);
+      else
+        pool.Add([scenario, profile, memoize]() { RunScenario(*scenario, profile, memoize); }, scenario->expectedCost_s);
+    }
+    pool.Run();
+  }
+  for (const ScenarioInfo* scenario : realTime)
+    RunScenario(*scenario, profile, memoize);
+  CloseBinaryLog();
+  return 0;
 }
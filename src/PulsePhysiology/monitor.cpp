@@ -0,0 +1,74 @@
+/* Distributed under the Apache License, Version 2.0.*/
+
+/// Follows a scenario run with --shm live, printing its rows as they are published
+/// Give the scenario, i.e. CPR, or the shared memory name of its ring, and optionally the columns to print,
+/// every column is printed otherwise. Rows the monitor fell too far behind on are skipped, and counted.
+#include "VitalsRing.h"
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cout << "\nUsage: PulsePhysiologyMonitor <scenario|/name> [column ...]\n";
+    return 1;
+  }
+  std::string name = argv[1][0] == '/' ? std::string(argv[1]) : VitalsRing::GetName(argv[1]);
+
+  // The run may not have started yet
+  VitalsRing::Reader ring;
+  std::cout << "Waiting for " << name << "\n";
+  while (!ring.Open(name))
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  const std::vector<std::string>& names = ring.GetColumnNames();
+  std::vector<size_t> columns;
+  for (int a = 2; a < argc; a++)
+  {
+    for (size_t c = 0; c < names.size(); c++)
+    {
+      if (names[c] == argv[a])
+        columns.push_back(c);
+    }
+  }
+  if (columns.empty())
+  {
+    for (size_t c = 0; c < names.size(); c++)
+      columns.push_back(c);
+  }
+  for (size_t c : columns)
+    std::cout << names[c] << (c == columns.back() ? "\n" : ", ");
+
+  std::vector<double> row(names.size());
+  uint64_t next = ring.GetOldest();
+  uint64_t skipped = 0;
+  while (true)
+  {
+    // Check if the run is over before reading, so the last rows are not missed
+    bool closed = ring.IsClosed();
+    VitalsRing::Reader::Status status = ring.Read(next, row.data());
+    if (status == VitalsRing::Reader::Status::Read)
+    {
+      for (size_t c : columns)
+        std::cout << row[c] << (c == columns.back() ? "\n" : ", ");
+      next++;
+    }
+    else if (status == VitalsRing::Reader::Status::Overwritten)
+    {
+      uint64_t oldest = ring.GetOldest();
+      skipped += oldest - next;
+      next = oldest;
+    }
+    else if (closed)
+      break;
+    else
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::cout << "The run is over";
+  if (skipped > 0)
+    std::cout << ", " << skipped << " rows were skipped";
+  std::cout << "\n";
+  return 0;
+}